@@ -7,24 +7,43 @@
 
 #include <cstdlib>
 #include <cstdio>
-#include <queue>
+#include <algorithm>
 #include <unordered_map>
 #include <string>
 #include <cctype>
 #include <cstring>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include "ai.h"
-#include "controller.h"
-#include "view.h"
+#include "bitboard.h"
+#include "book.h"
+#include "config.h"
+#include "endgame.h"
+#include "evalcache.h"
+#include "gamedb.h"
+#include "nnue.h"
+#include "replay.h"
+#include "stability.h"
+#include "trace.h"
+#include "transposition.h"
 
-typedef std::vector<treeNode*> Tree_level_t;
+// Funcion que redibuja la ventana durante la busqueda (drawView en el juego)
+static SearchProgressCallback g_progressCallback = nullptr;
 
-// Contador global para controlar las llamadas a drawView()
-static int g_drawViewCounter = 0;
 static const int DRAW_VIEW_INTERVAL = 1000; // Llamar cada 1000 nodos
+static const int SPLIT_NODE_BATCH = 1024;   // nodos de una tarea entre sumas al contador de la division
 
-// Variable global para guardar referencia al modelo (necesaria para drawView)
-static GameModel* g_currentModel = nullptr;
+static void drawProgress(GameModel &model) {
+    TRACE_SCOPE("drawView");
+    g_progressCallback(model);
+}
 
 // Convierte Square {x,y} a notación Othello "C4" (A1 es (0,0), H8 es (7,7))
 static std::string toAlg(Square s) {
@@ -42,18 +61,6 @@ static Square fromAlg(const std::string& alg) {
     return Square{ int(c - 'A'), int(r - '1') };
 }
 
-// Devuelve la cadena de historial en mayúsculas "C4C3D3..."
-static std::string historyStringUpper(const GameModel& model) {
-    std::string s;
-    s.reserve(model.moveHistory.size()*2);
-    for (const auto& mv : model.moveHistory) {
-        std::string a = toAlg(mv);
-        s.push_back(std::toupper(a[0]));
-        s.push_back(a[1]); // los dígitos ya están ok
-    }
-    return s;
-}
-
 // Tabla de aperturas: prefijo -> mejor siguiente jugada (ambas en mayúsculas).
 static const std::vector<std::pair<std::string,std::string>> OPENING_BOOK = {
     // --- Familias base (1 respuesta por línea clásica) ---
@@ -92,23 +99,108 @@ static const std::vector<std::pair<std::string,std::string>> OPENING_BOOK = {
     {"C4C3F5", "C5"},   // Semi-Wing: …F5 → C5 (blancas)
 };
 
-// Busca coincidencia exacta de prefijo y valida que la jugada sea legal.
-static bool openingBookBestMove(const GameModel& model, Square& outMove) {
-    std::string hist = historyStringUpper(model);
-    for (const auto& kv : OPENING_BOOK) {
+typedef std::vector<std::pair<std::string,std::string>> OpeningBook;
+
+// Libro activo: el incorporado o el que indique book.path en la configuracion
+static OpeningBook g_openingBook = OPENING_BOOK;
+
+// Indice del libro por posicion canonica: las 8 simetrias de una posicion
+// comparten entrada, asi una apertura en F5 encuentra la linea de C4.
+// La jugada se guarda ya transformada a la orientacion canonica.
+static std::unordered_map<uint64_t, Square> g_openingIndex;
+
+// Lee un libro de texto con una entrada por linea: "C4C3 D3".
+static bool loadOpeningBook(const char* path, OpeningBook& book) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    OpeningBook loaded;
+    std::string prefix, move;
+    while (file >> prefix >> move) {
+        for (auto& c : prefix) c = std::toupper(c);
+        for (auto& c : move) c = std::toupper(c);
+        loaded.push_back({prefix, move});
+    }
+    book.swap(loaded);
+    return true;
+}
+
+// Juega cada prefijo desde la posicion inicial y arma el indice canonico.
+// Si hay entradas repetidas para una misma posicion gana la primera.
+static void buildOpeningIndex(const OpeningBook& book) {
+    g_openingIndex.clear();
+
+    for (const auto& kv : book) {
         const std::string& prefix = kv.first;
-        if (hist == prefix) {
-            Square candidate = fromAlg(kv.second);
-            if (!isSquareValid(candidate)) return false;
-            Moves legal;
-            getValidMoves(model, legal);
-            for (auto m : legal) {
-                if (m.x == candidate.x && m.y == candidate.y) {
-                    outMove = candidate;
-                    return true;
-                }
-            }
-            return false;
+        tree_logic state;
+        startState(state);
+
+        bool legal = (prefix.size() % 2) == 0;
+        for (size_t i = 0; legal && i < prefix.size(); i += 2) {
+            Square mv = fromAlg(prefix.substr(i, 2));
+            legal = isSquareValid(mv) && getBoardPiece(state, mv) == PIECE_EMPTY;
+            if (legal) playMove(state, mv);
+        }
+
+        Square reply = fromAlg(kv.second);
+        if (!legal || !isSquareValid(reply)) {
+            printf("Entrada de libro invalida: %s %s\n", prefix.c_str(), kv.second.c_str());
+            continue;
+        }
+
+        int symmetry;
+        uint64_t key = canonicalHash(state, symmetry);
+        g_openingIndex.emplace(key, transformSquare(reply, symmetry));
+    }
+}
+
+// Indice de un libro binario de tools/book_build: cada posicion ya esta en
+// orientacion canonica, con la jugada elegida por minimax.
+static void buildBookIndex(const BookTree& book) {
+    g_openingIndex.clear();
+
+    for (const auto& kv : book.entries) {
+        if (kv.second.bestMove != BOOK_NO_MOVE) {
+            g_openingIndex.emplace(kv.first, unpackSquare(kv.second.bestMove));
+        }
+    }
+}
+
+// Libro de texto, libro binario o el incorporado segun book.path
+static void loadActiveBook(const AIConfig& config) {
+    const char* path = config.bookPath.c_str();
+
+    if (!config.bookPath.empty() && isBinaryBook(path)) {
+        BookTree book;
+        if (loadBook(path, book)) {
+            buildBookIndex(book);
+            return;
+        }
+        printf("No se pudo leer el libro %s, se usa el incorporado\n", path);
+        g_openingBook = OPENING_BOOK;
+    } else if (config.bookPath.empty()) {
+        g_openingBook = OPENING_BOOK;
+    } else if (!loadOpeningBook(path, g_openingBook)) {
+        printf("No se pudo leer el libro %s, se usa el incorporado\n", path);
+        g_openingBook = OPENING_BOOK;
+    }
+    buildOpeningIndex(g_openingBook);
+}
+
+// Busca la posicion actual en el libro y valida que la jugada sea legal.
+bool openingBookBestMove(const GameModel& model, Square& outMove) {
+    tree_logic state = gameStateFromModel(model);
+    int symmetry;
+    auto it = g_openingIndex.find(canonicalHash(state, symmetry));
+    if (it == g_openingIndex.end()) return false;
+
+    Square candidate = inverseTransformSquare(it->second, symmetry);
+    Moves legal;
+    getValidMoves(model, legal);
+    for (auto m : legal) {
+        if (m.x == candidate.x && m.y == candidate.y) {
+            outMove = candidate;
+            return true;
         }
     }
     return false;
@@ -139,44 +231,12 @@ int evaluateAdyacents(tree_logic &model, Player ia_player, Square move){
     return 0; 
 }
 
-int evaluateStability(tree_logic &model, Player ia_player, Square move){
-    int stability = -1;
-    Piece ia_piece = (ia_player == PLAYER_WHITE) ? PIECE_WHITE : PIECE_BLACK;
-
-    static int directions[8][2] = {
-        {1, 0}, {-1, 0}, {0, 1}, {0, -1},
-        {1, 1}, {1, -1}, {-1, 1}, {-1, -1}
-    };
-
-    for(int i = 0; i<8; i++){
-        int dir[2] = {directions[i][0], directions[i][1]};
-
-        for(int j = 1; j < BOARD_SIZE && stability; j++){
-            Square currentPos = {move.x + j*dir[0], move.y + j*dir[1]};
-            
-            if(isSquareValid(currentPos) == false){
-                stability = false;
-                break;
-            }
-
-            if(getBoardPiece(model, currentPos) == PIECE_EMPTY){
-                stability = false;
-                break;
-            }else if(getBoardPiece(model, currentPos) == ia_piece){
-                stability = true;
-                continue;
-            }else{
-                stability = false;
-                break;
-            }    
-        }
-
-        if(stability == true){
-            break;
-        }
-    }
-
-    return stability == true? 1 : 0;
+// Fichas estables de la IA menos las del rival (ver stability.h)
+int evaluateStability(tree_logic &model, Player ia_player){
+    Bitboard board = getBitboard(model);
+    uint64_t own, opponent;
+    splitBitboard(board, ia_player, own, opponent);
+    return countStableDiscs(own, opponent) - countStableDiscs(opponent, own);
 }
 
 int isXsquareCorner(tree_logic &model, Square move){
@@ -187,219 +247,1238 @@ int isXsquareCorner(tree_logic &model, Square move){
     return 0;
 }
 
-int value_state(tree_logic & model, Player ia_player, Square move){
-    if(model.gameOver) return 0; 
+int value_state(tree_logic & model, Player ia_player, Square move, EvalWeights const& weights){
+    if(model.gameOver) return FINAL_DISC_VALUE * pieceDifference(model, ia_player);
     
     int score_dif = pieceDifference(model, ia_player);
     int movility = evaluateMovility(model, ia_player);
     int adyacents = evaluateAdyacents(model, ia_player, move);
     int corner = isXsquareCorner(model, move);
+    int stability = (weights.stability != 0) ? evaluateStability(model, ia_player) : 0;
 
-    int value = (10 * score_dif) + (5 * movility) + 
-                (50 * corner) + (3 * adyacents);
+    int value = (weights.pieces * score_dif) + (weights.mobility * movility) + 
+                (weights.corners * corner) + (weights.adjacents * adyacents) +
+                (weights.stability * stability);
 
     return value;
 }
 
-void init_tree(tree_logic const& state, Tree_level_t& Tree_level, int depth, int maxDepth, 
-               int &g_nodesExplored, int g_maxNodes, bool fuerza_bruta){
+struct SplitPool;
+struct SplitPoint;
 
-    if (g_nodesExplored >= g_maxNodes) {
+// Estado de una busqueda: un solo tablero que se modifica en el lugar y los
+// limites que salen de la configuracion para la etapa actual.
+struct SearchContext {
+    tree_logic state;
+    UndoStack undo;
+    Player ia_player;
+    EvalWeights weights;
+    GameStage stage;
+    int maxDepth;
+    bool fuerza_bruta;
+    int nodesExplored;
+    int maxNodes;
+    double deadline;        // segundos de searchClock(), 0 = sin limite
+    bool outOfTime;
+    ProbCutTable const* probCut;    // nullptr = sin ProbCut
+    double probCutThreshold;
+    bool inProbCut;
+    int probCutCuts;
+    TranspositionTable* tt;         // nullptr = sin tabla
+    uint64_t hash;                  // clave Zobrist de state
+    EndgameCache* endgame;          // nullptr = sin cache de finales
+    int endgameMinEmpties;
+    int endgameMaxEmpties;
+    int endgameHits;
+    int stabilityCuts;
+    EvalCache* evalCache;           // nullptr = sin cache de evaluaciones
+    int evalCacheProbes;
+    int evalCacheHits;
+    GameModel* progressModel;       // modelo para redibujar, nullptr = sin ventana
+    int progressCounter;            // nodos desde el ultimo redibujo
+    std::atomic<bool> const* stop;  // cortar al subir (ayudante o tarea podada), nullptr = nunca
+    SplitPool* splitPool;           // reparte finales entre hilos, nullptr = secuencial
+    SplitPoint* split;              // punto de division de la tarea, nullptr = hilo principal
+    std::atomic<int64_t>* splitNodes;   // nodos de toda la division contra maxNodes, nullptr = solo los propios
+    int splitNodesFlushed;          // nodos propios ya sumados a splitNodes
+    int splitMinEmpties;
+    NnueNetwork const* nnue;        // evaluacion neuronal, nullptr = value_state
+    int nnueTop;                    // acumulador de state en nnueStack
+    NnueAccumulator nnueStack[UNDO_STACK_SIZE + 1];
+};
+
+// Division de finales (Young Brothers Wait): en un nodo de fuerza bruta con
+// suficientes casillas vacias, despues de resolver el primer hijo los demas
+// quedan a disposicion de los hilos libres. Cada tarea busca un hijo sobre
+// una copia del contexto y achica la ventana del nodo; si hay corte, las
+// tareas de ese nodo y de sus divisiones internas se abandonan.
+struct SplitPoint {
+    SplitPoint* parent;
+    SearchContext base;             // contexto en el nodo dividido
+    Square move;
+    int depth;
+    bool maximizing;
+    Moves children;
+    size_t next;                    // siguiente hijo sin tomar
+    int running;                    // tareas buscando
+    int alpha;
+    int beta;
+    int bestValue;
+    Square bestChild;
+    int nodes;
+    int endgameHits;
+    int stabilityCuts;
+    int evalCacheProbes;
+    int evalCacheHits;
+    bool exhausted;                 // alguna tarea se quedo sin nodos o tiempo
+    bool outOfTime;
+    std::atomic<bool> aborted;
+    std::atomic<int64_t> totalNodes;    // de la division mas externa, compartido por las de adentro
+};
+
+struct SplitPool {
+    std::mutex mutex;
+    std::condition_variable wakeup; // hay hijos para tomar
+    std::condition_variable done;   // termino una tarea
+    std::vector<SplitPoint*> active;
+    bool stopping;
+};
+
+// Las hojas dependen de la ultima jugada (esquinas y adyacentes) y del
+// jugador de la IA, asi que ambos entran en la clave de la tabla.
+static uint64_t nodeKey(SearchContext const& ctx, Square move) {
+    uint64_t key = ctx.hash ^ zobristSquare(move);
+    return (ctx.ia_player == PLAYER_WHITE) ? ~key : key;
+}
+
+// Altura restante del nodo; en fuerza bruta se busca hasta el final
+static int nodeHeight(SearchContext const& ctx, int depth) {
+    return ctx.fuerza_bruta ? BOARD_SIZE * BOARD_SIZE : ctx.maxDepth - depth;
+}
+
+// Juega un hijo actualizando tambien la clave Zobrist
+static void playChild(SearchContext &ctx, Square child) {
+    Player mover = ctx.state.currentPlayer;
+    FlipMask flips = makeMove(ctx.state, child, ctx.undo);
+    ctx.hash = zobristUpdate(ctx.hash, child, flips, mover, ctx.state.currentPlayer);
+
+    if (ctx.nnue != nullptr) {
+        ctx.nnueStack[ctx.nnueTop + 1] = ctx.nnueStack[ctx.nnueTop];
+        ctx.nnueTop++;
+        updateNnueAccumulator(*ctx.nnue, ctx.nnueStack[ctx.nnueTop], child, flips, mover);
+    }
+
+    // La entrada del hijo se trae a la cache mientras se generan sus jugadas
+    if (ctx.tt != nullptr) {
+        prefetchTranspositionTable(*ctx.tt, nodeKey(ctx, child));
+    }
+}
+
+// Deshace el ultimo hijo; la clave Zobrist la restaura quien lo jugo
+static void undoChild(SearchContext &ctx) {
+    undoMove(ctx.state, ctx.undo);
+    if (ctx.nnue != nullptr) {
+        ctx.nnueTop--;
+    }
+}
+
+// Valor de una hoja: la red si hay una cargada, si no value_state. Los
+// finales de partida siempre valen la diferencia exacta. La misma hoja
+// aparece muchas veces (transposiciones, iteraciones, ventanas nulas), asi
+// que se guarda con la clave de la tabla, que ya incluye la ultima jugada.
+static int evaluateLeaf(SearchContext &ctx, Square move) {
+    if (ctx.state.gameOver) {
+        return value_state(ctx.state, ctx.ia_player, move, ctx.weights);
+    }
+
+    uint64_t key = 0;
+    int value;
+    if (ctx.evalCache != nullptr) {
+        key = nodeKey(ctx, move);
+        ctx.evalCacheProbes++;
+        if (probeEvalCache(*ctx.evalCache, key, value)) {
+            ctx.evalCacheHits++;
+            return value;
+        }
+    }
+
+    if (ctx.nnue == nullptr) {
+        value = value_state(ctx.state, ctx.ia_player, move, ctx.weights);
+    } else {
+        value = evaluateNnue(*ctx.nnue, ctx.nnueStack[ctx.nnueTop], ctx.state.currentPlayer);
+        value = (ctx.ia_player == PLAYER_BLACK) ? value : -value;
+    }
+
+    if (ctx.evalCache != nullptr) {
+        storeEvalCache(*ctx.evalCache, key, value);
+    }
+    return value;
+}
+
+static double searchClock() {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Suma al contador de la division los nodos propios que faltan
+static void flushSplitNodes(SearchContext &ctx) {
+    ctx.splitNodes->fetch_add(ctx.nodesExplored - ctx.splitNodesFlushed, std::memory_order_relaxed);
+    ctx.splitNodesFlushed = ctx.nodesExplored;
+}
+
+// En una division el tope de nodos es de todas las tareas juntas: cada una
+// suma sus nodos al contador compartido de a tandas
+static bool nodesExhausted(SearchContext &ctx) {
+    if (ctx.splitNodes == nullptr) {
+        return ctx.nodesExplored >= ctx.maxNodes;
+    }
+    if (ctx.nodesExplored - ctx.splitNodesFlushed >= SPLIT_NODE_BATCH) {
+        flushSplitNodes(ctx);
+    }
+    return ctx.splitNodes->load(std::memory_order_relaxed) +
+           (ctx.nodesExplored - ctx.splitNodesFlushed) >= ctx.maxNodes;
+}
+
+static bool searchExhausted(SearchContext &ctx) {
+    return nodesExhausted(ctx) || ctx.outOfTime ||
+           (ctx.stop != nullptr && ctx.stop->load(std::memory_order_relaxed));
+}
+
+int minimax(SearchContext &ctx, Square move, int depth, int alpha, int beta);
+static bool canSplit(SearchContext const& ctx, size_t remaining);
+static void splitSearch(SearchContext &ctx, Square move, int depth, bool maximizing,
+                        Moves const& children, int &alpha, int &beta,
+                        int &bestValue, Square &bestChild);
+
+// Clave de la posicion en la cache de finales, 0 si no corresponde buscarla:
+// solo en fuerza bruta, donde los valores son resultados exactos
+static uint64_t endgameKey(SearchContext const& ctx, Bitboard const& board, int &empties) {
+    if (ctx.endgame == nullptr || !ctx.fuerza_bruta) {
+        return 0;
+    }
+
+    empties = BOARD_SIZE * BOARD_SIZE - __builtin_popcountll(board.black | board.white);
+    if (empties < ctx.endgameMinEmpties || empties > ctx.endgameMaxEmpties) {
+        return 0;
+    }
+    return canonicalHash(board, ctx.state.currentPlayer);
+}
+
+// Las fichas estables ya son de su dueño al final de la partida: acotan la
+// diferencia final de la IA entre 2 * estables propias - 64 y
+// 64 - 2 * estables del rival. Solo se calculan si la cota puede podar.
+static bool tryStabilityCutoff(SearchContext &ctx, Bitboard const& board,
+                               int alpha, int beta, int &cutValue) {
+    const int squares = BOARD_SIZE * BOARD_SIZE;
+    uint64_t own, opponent;
+    splitBitboard(board, ctx.ia_player, own, opponent);
+
+    if (alpha > -squares * FINAL_DISC_VALUE) {
+        int upper = (squares - 2 * countStableDiscs(opponent, own)) * FINAL_DISC_VALUE;
+        if (upper <= alpha) {
+            cutValue = upper;
+            ctx.stabilityCuts++;
+            return true;
+        }
+    }
+    if (beta < squares * FINAL_DISC_VALUE) {
+        int lower = (2 * countStableDiscs(own, opponent) - squares) * FINAL_DISC_VALUE;
+        if (lower >= beta) {
+            cutValue = lower;
+            ctx.stabilityCuts++;
+            return true;
+        }
+    }
+    return false;
+}
+
+// La cache guarda fichas para el jugador que mueve; la busqueda usa valores
+// del jugador de la IA
+static void endgameToSearch(SearchContext const& ctx, int lower, int upper, int &low, int &high) {
+    if (ctx.state.currentPlayer == ctx.ia_player) {
+        low = lower * FINAL_DISC_VALUE;
+        high = upper * FINAL_DISC_VALUE;
+    } else {
+        low = -upper * FINAL_DISC_VALUE;
+        high = -lower * FINAL_DISC_VALUE;
+    }
+}
+
+static void storeEndgameResult(SearchContext &ctx, uint64_t key, int empties,
+                               int value, int alpha, int beta) {
+    if (value % FINAL_DISC_VALUE != 0) {
         return;
     }
+
+    int discs = value / FINAL_DISC_VALUE;
+    int low = (value <= alpha) ? -BOARD_SIZE * BOARD_SIZE : discs;
+    int high = (value >= beta) ? BOARD_SIZE * BOARD_SIZE : discs;
+
+    if (ctx.state.currentPlayer == ctx.ia_player) {
+        storeEndgameCache(*ctx.endgame, key, empties, low, high);
+    } else {
+        storeEndgameCache(*ctx.endgame, key, empties, -high, -low);
+    }
+}
+
+// Multi-ProbCut: una busqueda corta con ventana nula predice el valor de la
+// profunda (deep ~= a * shallow + b). Si la prediccion queda a mas de
+// threshold sigmas fuera de (alpha, beta) se poda el nodo entero.
+// Devuelve true y deja en cutValue la cota a devolver.
+static bool tryProbCut(SearchContext &ctx, Square move, int depth, int alpha, int beta, int &cutValue) {
+    int height = ctx.maxDepth - depth;
+    if (ctx.probCut == nullptr || ctx.inProbCut || ctx.fuerza_bruta ||
+        height < PROBCUT_MIN_HEIGHT || height > PROBCUT_MAX_HEIGHT) {
+        return false;
+    }
+
+    ProbCutPair const& pair = ctx.probCut->pairs[ctx.stage][height];
+    if (!pair.valid) {
+        return false;
+    }
+
+    double margin = ctx.probCutThreshold * pair.sigma;
+    int savedMaxDepth = ctx.maxDepth;
+    ctx.maxDepth = depth + pair.shallowDepth;
+    ctx.inProbCut = true;
+
+    bool cut = false;
+    if (beta < SEARCH_INFINITY) {
+        int bound = (int)std::ceil((beta + margin - pair.b) / pair.a);
+        if (minimax(ctx, move, depth, bound - 1, bound) >= bound) {
+            cutValue = beta;
+            cut = true;
+        }
+    }
+    if (!cut && alpha > -SEARCH_INFINITY) {
+        int bound = (int)std::floor((alpha - margin - pair.b) / pair.a);
+        if (minimax(ctx, move, depth, bound, bound + 1) <= bound) {
+            cutValue = alpha;
+            cut = true;
+        }
+    }
+
+    ctx.maxDepth = savedMaxDepth;
+    ctx.inProbCut = false;
+    if (cut) {
+        ctx.probCutCuts++;
+    }
+    return cut;
+}
+
+// Algoritmo Minimax recursivo en profundidad con poda alfa-beta. Trabaja
+// siempre sobre el mismo estado: cada hijo se juega con makeMove y se revierte
+// con undoMove, asi que no se copia el tablero ni se arma el arbol en memoria.
+int minimax(SearchContext &ctx, Square move, int depth, int alpha, int beta) {
     
-    if ((depth >= maxDepth && !fuerza_bruta) || state.gameOver) {
-        return;
+    // CRÍTICO: Llamar a drawView() periódicamente
+    ctx.progressCounter++;
+    if (ctx.progressCounter >= DRAW_VIEW_INTERVAL) {
+        if (ctx.progressModel != nullptr && g_progressCallback != nullptr) {
+            drawProgress(*ctx.progressModel);
+        }
+        if (ctx.deadline > 0 && searchClock() >= ctx.deadline) {
+            ctx.outOfTime = true;
+        }
+        ctx.progressCounter = 0;
     }
+
+    tree_logic &state = ctx.state;
     
+    // Caso base
+    if ((depth >= ctx.maxDepth && !ctx.fuerza_bruta) || state.gameOver || searchExhausted(ctx)) {
+        return evaluateLeaf(ctx, move);
+    }
+
+    // En fuerza bruta los valores son resultados exactos: las fichas estables
+    // los acotan y los finales ya resueltos, en esta partida o en otra
+    // anterior, salen de la cache
+    int empties = 0;
+    uint64_t solvedKey = 0;
+    if (ctx.fuerza_bruta) {
+        Bitboard board = getBitboard(state);
+        int cutValue;
+        if (tryStabilityCutoff(ctx, board, alpha, beta, cutValue)) {
+            return cutValue;
+        }
+
+        solvedKey = endgameKey(ctx, board, empties);
+        int lower, upper;
+        if (solvedKey != 0 && probeEndgameCache(*ctx.endgame, solvedKey, lower, upper)) {
+            int low, high;
+            endgameToSearch(ctx, lower, upper, low, high);
+            if (low == high || low >= beta || high <= alpha) {
+                ctx.endgameHits++;
+                return (low >= beta) ? low : high;
+            }
+        }
+    }
+
+    int height = nodeHeight(ctx, depth);
+    uint64_t key = nodeKey(ctx, move);
+    Square ttMove = GAME_INVALID_SQUARE;
+    TTEntry entry;
+
+    if (ctx.tt != nullptr && probeTranspositionTable(*ctx.tt, key, entry)) {
+        ttMove = getEntryMove(entry);
+        if (entry.height >= height) {
+            if (entry.bound == TT_EXACT ||
+                (entry.bound == TT_LOWER && entry.value >= beta) ||
+                (entry.bound == TT_UPPER && entry.value <= alpha)) {
+                return entry.value;
+            }
+        }
+    }
+
+    int cutValue;
+    if (tryProbCut(ctx, move, depth, alpha, beta, cutValue)) {
+        return cutValue;
+    }
+
     Moves valid_moves;
     getValidMoves(state, valid_moves);
-    
-    for(auto move : valid_moves){
-        if (g_nodesExplored >= g_maxNodes) {
-            return;
+
+    // La mejor jugada guardada en la tabla va primero
+    for (size_t i = 1; i < valid_moves.size() && isSquareValid(ttMove); i++) {
+        if (valid_moves[i].x == ttMove.x && valid_moves[i].y == ttMove.y) {
+            std::swap(valid_moves[0], valid_moves[i]);
+            break;
         }
-        
-        treeNode* node = new treeNode;
-        node->square = move;
-        node->value = 0;
-        
-        g_nodesExplored++;
-        
-        // CRÍTICO: Llamar a drawView() periódicamente
-        g_drawViewCounter++;
-        if (g_drawViewCounter >= DRAW_VIEW_INTERVAL && g_currentModel != nullptr) {
-            Moves emptyMoves; // No mostramos movimientos válidos durante el cálculo
-            drawView(*g_currentModel, emptyMoves);
-            g_drawViewCounter = 0;
+    }
+
+    int alphaOrig = alpha;
+    int betaOrig = beta;
+    bool maximizing = (state.currentPlayer == ctx.ia_player);
+    int bestValue = maximizing ? -SEARCH_INFINITY : SEARCH_INFINITY;
+    Square bestChild = GAME_INVALID_SQUARE;
+    bool expanded = false;
+
+    for (size_t i = 0; i < valid_moves.size(); i++) {
+        if (searchExhausted(ctx)) {
+            break;
         }
-        
-        tree_logic child_state = state;
-        playMove(child_state, move);
-        node->state = child_state;
 
-        Tree_level.push_back(node);
+        // Resuelto el primer hijo, los demas se reparten entre los hilos
+        if (i == 1 && canSplit(ctx, valid_moves.size() - 1)) {
+            Moves rest(valid_moves.begin() + 1, valid_moves.end());
+            splitSearch(ctx, move, depth, maximizing, rest, alpha, beta, bestValue, bestChild);
+            break;
+        }
+
+        Square child = valid_moves[i];
+        ctx.nodesExplored++;
+        expanded = true;
+
+        uint64_t parentHash = ctx.hash;
+        playChild(ctx, child);
+        int value = minimax(ctx, child, depth + 1, alpha, beta);
+        undoChild(ctx);
+        ctx.hash = parentHash;
 
-        init_tree(child_state, node->children, depth+1, maxDepth, g_nodesExplored, g_maxNodes, fuerza_bruta);
+        if (maximizing ? (value > bestValue) : (value < bestValue)) {
+            bestValue = value;
+            bestChild = child;
+        }
+        if (maximizing) {
+            alpha = std::max(alpha, value);
+        } else {
+            beta = std::min(beta, value);
+        }
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    // Si se agoto el presupuesto antes de abrir un hijo, es una hoja
+    if (!expanded) {
+        return evaluateLeaf(ctx, move);
+    }
+
+    // Un resultado cortado por nodos o tiempo no es confiable para la tabla
+    if (ctx.tt != nullptr && !searchExhausted(ctx)) {
+        TTBound bound = (bestValue <= alphaOrig) ? TT_UPPER :
+                        (bestValue >= betaOrig) ? TT_LOWER : TT_EXACT;
+        storeTranspositionTable(*ctx.tt, key, bestValue, height, bound, bestChild);
     }
+    if (solvedKey != 0 && !searchExhausted(ctx)) {
+        storeEndgameResult(ctx, solvedKey, empties, bestValue, alphaOrig, betaOrig);
+    }
+
+    return bestValue;
 }
 
-void free_tree(Tree_level_t & Tree_level){
-    for(auto level : Tree_level){
-        free_tree(level->children);
-        delete level;
+static bool canSplit(SearchContext const& ctx, size_t remaining) {
+    if (ctx.splitPool == nullptr || !ctx.fuerza_bruta || remaining < 2) {
+        return false;
     }
-    Tree_level.clear();
+    Bitboard board = getBitboard(ctx.state);
+    int empties = BOARD_SIZE * BOARD_SIZE - __builtin_popcountll(board.black | board.white);
+    return empties >= ctx.splitMinEmpties;
 }
 
-int Recorrido_BFS(treeNode* node, Player ia_player, int maxNodesExplored){
-    static int maxValue = -100;
-    static int minValue = 100;
-    int g_nodesExplored = 0;
-    Square move = node->square;
+// Marca como abandonada una division y todas las que se abrieron debajo.
+// Con la pool trabada.
+static void abortSplit(SplitPool &pool, SplitPoint* split) {
+    for (auto active : pool.active) {
+        for (SplitPoint* p = active; p != nullptr; p = p->parent) {
+            if (p == split) {
+                active->aborted = true;
+                break;
+            }
+        }
+    }
+}
 
-    if(node->children.empty()){
-        return 0;
+// Busca el siguiente hijo de una division. Entra y sale con la pool trabada.
+static void runSplitTask(SplitPool &pool, SplitPoint* split, std::unique_lock<std::mutex> &lock) {
+    Square child = split->children[split->next++];
+    split->running++;
+    int alpha = split->alpha;
+    int beta = split->beta;
+    lock.unlock();
+
+    SearchContext ctx = split->base;
+    ctx.undo.size = 0;
+    ctx.nodesExplored = 0;
+    ctx.splitNodesFlushed = 0;
+    ctx.endgameHits = 0;
+    ctx.stabilityCuts = 0;
+    ctx.evalCacheProbes = 0;
+    ctx.evalCacheHits = 0;
+    ctx.progressModel = nullptr;
+    ctx.progressCounter = 0;
+    ctx.stop = &split->aborted;
+    ctx.split = split;
+
+    int value;
+    {
+        TRACE_SCOPE_ARG("division", "profundidad", split->depth + 1);
+        ctx.nodesExplored++;
+        playChild(ctx, child);
+        value = minimax(ctx, child, split->depth + 1, alpha, beta);
     }
-    std::queue<treeNode *> q;
-    for(auto treeNode:node->children){
-        q.push(node);
+    bool exhausted = nodesExhausted(ctx);
+    flushSplitNodes(ctx);
+
+    lock.lock();
+    split->running--;
+    split->nodes += ctx.nodesExplored;
+    split->endgameHits += ctx.endgameHits;
+    split->stabilityCuts += ctx.stabilityCuts;
+    split->evalCacheProbes += ctx.evalCacheProbes;
+    split->evalCacheHits += ctx.evalCacheHits;
+
+    if (split->aborted) {
+        // Nada: el resultado del nodo ya no importa
+    } else if (ctx.outOfTime || exhausted) {
+        split->exhausted = true;
+        split->outOfTime |= ctx.outOfTime;
+        abortSplit(pool, split);
+    } else {
+        if (split->maximizing ? (value > split->bestValue) : (value < split->bestValue)) {
+            split->bestValue = value;
+            split->bestChild = child;
+        }
+        if (split->maximizing) {
+            split->alpha = std::max(split->alpha, value);
+        } else {
+            split->beta = std::min(split->beta, value);
+        }
+        if (split->alpha >= split->beta) {
+            abortSplit(pool, split);
+        }
     }
-    while(!q.empty() && g_nodesExplored < maxNodesExplored && maxValue < minValue){
-        treeNode *node = q.front();
-        q.pop();
+    pool.done.notify_all();
+}
 
-        // CRÍTICO: Llamar a drawView() periódicamente
-        g_drawViewCounter++;
-        if (g_drawViewCounter >= DRAW_VIEW_INTERVAL && g_currentModel != nullptr) {
-            Moves emptyMoves;
-            drawView(*g_currentModel, emptyMoves);
-            g_drawViewCounter = 0;
+static bool hasPendingChildren(SplitPoint const* split) {
+    return !split->aborted && split->next < split->children.size();
+}
+
+// Division que conviene robar: la de menor profundidad, con los arboles
+// mas grandes. Con profundidad minima para que el dueño de una division solo
+// ayude en arboles mas chicos que el suyo y vuelva pronto.
+static SplitPoint* findSplitTask(SplitPool &pool, int minDepth) {
+    SplitPoint* best = nullptr;
+    for (auto split : pool.active) {
+        if (hasPendingChildren(split) && split->depth >= minDepth &&
+            (best == nullptr || split->depth < best->depth)) {
+            best = split;
         }
+    }
+    return best;
+}
+
+static void runSplitWorker(SplitPool* pool) {
+    std::unique_lock<std::mutex> lock(pool->mutex);
 
-        if (node->state.currentPlayer == ia_player) {
-            int value = value_state(node->state, ia_player, move);
-            maxValue += value;
+    while (true) {
+        SplitPoint* split = nullptr;
+        pool->wakeup.wait(lock, [pool, &split] {
+            split = findSplitTask(*pool, 0);
+            return pool->stopping || split != nullptr;
+        });
+        if (pool->stopping) {
+            return;
         }
-        else {
-            int value = value_state(node->state, ia_player, move);
-            minValue -= value;
+        runSplitTask(*pool, split, lock);
+    }
+}
+
+static void splitSearch(SearchContext &ctx, Square move, int depth, bool maximizing,
+                        Moves const& children, int &alpha, int &beta,
+                        int &bestValue, Square &bestChild) {
+    SplitPool &pool = *ctx.splitPool;
+
+    // Las tareas cuentan contra el mismo tope que el nodo dividido: la
+    // division mas externa abre el contador con los nodos hechos hasta aca
+    SplitPoint split;
+    if (ctx.splitNodes != nullptr) {
+        flushSplitNodes(ctx);
+    }
+    split.parent = ctx.split;
+    split.base = ctx;
+    split.totalNodes = ctx.nodesExplored;
+    if (ctx.splitNodes == nullptr) {
+        split.base.splitNodes = &split.totalNodes;
+    }
+    split.move = move;
+    split.depth = depth;
+    split.maximizing = maximizing;
+    split.children = children;
+    split.next = 0;
+    split.running = 0;
+    split.alpha = alpha;
+    split.beta = beta;
+    split.bestValue = bestValue;
+    split.bestChild = bestChild;
+    split.nodes = 0;
+    split.endgameHits = 0;
+    split.stabilityCuts = 0;
+    split.evalCacheProbes = 0;
+    split.evalCacheHits = 0;
+    split.exhausted = false;
+    split.outOfTime = false;
+    split.aborted = (ctx.split != nullptr && ctx.split->aborted);
+
+    std::unique_lock<std::mutex> lock(pool.mutex);
+    pool.active.push_back(&split);
+    pool.wakeup.notify_all();
+
+    // El dueño busca sus propios hijos y, mientras espera a los demas, ayuda
+    // en divisiones mas hondas
+    while (true) {
+        if (hasPendingChildren(&split)) {
+            runSplitTask(pool, &split, lock);
+        } else if (split.running == 0) {
+            break;
+        } else if (SplitPoint* other = findSplitTask(pool, depth + 1)) {
+            runSplitTask(pool, other, lock);
+        } else if (ctx.progressModel != nullptr && g_progressCallback != nullptr) {
+            pool.done.wait_for(lock, std::chrono::milliseconds(50));
+            lock.unlock();
+            drawProgress(*ctx.progressModel);
+            lock.lock();
+        } else {
+            pool.done.wait(lock);
         }
+    }
+
+    pool.active.erase(std::find(pool.active.begin(), pool.active.end(), &split));
+    lock.unlock();
+
+    // Las tareas ya sumaron sus nodos al contador compartido
+    ctx.nodesExplored += split.nodes;
+    ctx.splitNodesFlushed += split.nodes;
+    ctx.endgameHits += split.endgameHits;
+    ctx.stabilityCuts += split.stabilityCuts;
+    ctx.evalCacheProbes += split.evalCacheProbes;
+    ctx.evalCacheHits += split.evalCacheHits;
+    if (split.exhausted) {
+        // Como en la busqueda secuencial: el nodo queda sin valor confiable.
+        // Sin tiempo lo dice outOfTime; sin nodos, el contador compartido
+        // ya llego al tope
+        ctx.outOfTime |= split.outOfTime;
+    }
+
+    alpha = split.alpha;
+    beta = split.beta;
+    bestValue = split.bestValue;
+    bestChild = split.bestChild;
+}
 
-        g_nodesExplored++;
+// Busca la raiz con ventana (alpha, beta), fail-soft. Con pvs, solo la primera
+// jugada usa la ventana completa: las demas se prueban con ventana nula
+// contra el mejor valor y se vuelven a buscar solo si la superan.
+static SearchResult searchRootWindow(SearchContext &ctx, Moves const& rootMoves,
+                                     int alpha, int beta, bool pvs) {
+    SearchResult result;
+    result.bestMove = GAME_INVALID_SQUARE;
+    result.value = -SEARCH_INFINITY;
 
-        for(auto childNode : node->children){
-            q.push(childNode);
+    for (auto move : rootMoves) {
+        if (searchExhausted(ctx)) {
+            break;
+        }
+        TRACE_SCOPE_ARG("jugada raiz", "casilla", move.y * BOARD_SIZE + move.x);
+        ctx.nodesExplored++;
+
+        uint64_t parentHash = ctx.hash;
+        playChild(ctx, move);
+
+        int value;
+        int low = std::max(alpha, result.value);
+        if (pvs && isSquareValid(result.bestMove) && low < beta) {
+            value = minimax(ctx, move, 1, low, low + 1);
+            if (value > low && value < beta) {
+                value = minimax(ctx, move, 1, value, beta);
+            }
+        } else {
+            value = minimax(ctx, move, 1, low, beta);
+        }
+
+        undoChild(ctx);
+        ctx.hash = parentHash;
+        
+        if (value > result.value || !isSquareValid(result.bestMove)) {
+            result.value = value;
+            result.bestMove = move;
+        }
+        if (result.value >= beta) {
+            break;
         }
     }
 
-    return (maxValue +1000) - (minValue-1000);
+    return result;
 }
 
-// Algoritmo Minimax recursivo
-int minimax(treeNode* node, Player ia_player, Player humanPlayer, int depth, int maxDepth, bool fuerza_bruta) {
-    
-    // CRÍTICO: Llamar a drawView() periódicamente
-    g_drawViewCounter++;
-    if (g_drawViewCounter >= DRAW_VIEW_INTERVAL && g_currentModel != nullptr) {
-        Moves emptyMoves;
-        drawView(*g_currentModel, emptyMoves);
-        g_drawViewCounter = 0;
+// Pone una jugada al principio de la lista (la mejor de la iteracion anterior)
+static void moveToFront(Moves &moves, Square first) {
+    for (size_t i = 1; i < moves.size(); i++) {
+        if (moves[i].x == first.x && moves[i].y == first.y) {
+            std::rotate(moves.begin(), moves.begin() + i, moves.begin() + i + 1);
+            return;
+        }
     }
-    
-    // Caso base
-    if ((depth >= maxDepth && !fuerza_bruta) || node->children.empty()) {
-        return value_state(node->state, ia_player, node->square);
+}
+
+// Una iteracion con ventana de aspiracion alrededor del valor anterior; si
+// falla para algun lado se agranda la ventana y se repite.
+static SearchResult aspirationIteration(SearchContext &ctx, Moves const& rootMoves,
+                                        int guess, int window) {
+    int alpha = guess - window;
+    int beta = guess + window;
+
+    while (true) {
+        SearchResult result = searchRootWindow(ctx, rootMoves, alpha, beta, true);
+        if (searchExhausted(ctx)) {
+            return result;
+        }
+        if (result.value <= alpha && alpha > -SEARCH_INFINITY) {
+            window *= 2;
+            alpha = std::max(-SEARCH_INFINITY, guess - window);
+        } else if (result.value >= beta && beta < SEARCH_INFINITY) {
+            window *= 2;
+            beta = std::min(SEARCH_INFINITY, guess + window);
+        } else {
+            return result;
+        }
     }
-    
-    if (node->state.currentPlayer == ia_player) {
-        int maxValue = -1000;
-        
-        for (auto child : node->children) {
-            int value = minimax(child, ia_player, humanPlayer, depth + 1, maxDepth, fuerza_bruta);
-            maxValue = std::max(maxValue, value);
+}
+
+// MTD(f): solo busquedas con ventana nula que acotan el valor desde arriba
+// y desde abajo hasta que se encuentran. La tabla evita repetir trabajo.
+static SearchResult mtdfIteration(SearchContext &ctx, Moves const& rootMoves, int guess) {
+    int lower = -SEARCH_INFINITY;
+    int upper = SEARCH_INFINITY;
+    SearchResult best;
+    best.bestMove = GAME_INVALID_SQUARE;
+    best.value = guess;
+
+    while (lower < upper) {
+        int beta = (best.value == lower) ? best.value + 1 : best.value;
+        SearchResult result = searchRootWindow(ctx, rootMoves, beta - 1, beta, false);
+        if (searchExhausted(ctx)) {
+            break;
         }
-        
-        node->value = maxValue;
-        return maxValue;
-        
+
+        if (result.value < beta) {
+            upper = result.value;
+            if (!isSquareValid(best.bestMove) || lower == -SEARCH_INFINITY) {
+                best.bestMove = result.bestMove;    // solo cota superior por ahora
+            }
+        } else {
+            lower = result.value;
+            best.bestMove = result.bestMove;        // esta jugada alcanza al menos beta
+        }
+        best.value = result.value;
+    }
+
+    return best;
+}
+
+// Elige la jugada segun el driver configurado
+static SearchResult searchRoot(SearchContext &ctx, SearchDriver driver, int aspirationWindow) {
+    TRACE_SCOPE_ARG("searchRoot", "profundidad", ctx.fuerza_bruta ? 0 : ctx.maxDepth);
+    Moves rootMoves;
+    getValidMoves(ctx.state, rootMoves);
+
+    SearchResult result;
+    result.bestMove = GAME_INVALID_SQUARE;
+    result.value = -SEARCH_INFINITY;
+    result.depth = 0;
+
+    if (driver == DRIVER_PLAIN || driver == DRIVER_PVS) {
+        result = searchRootWindow(ctx, rootMoves, -SEARCH_INFINITY, SEARCH_INFINITY,
+                                  driver == DRIVER_PVS);
+        result.depth = ctx.fuerza_bruta ? 0 : ctx.maxDepth;
     } else {
-        int minValue = 1000;
-        
-        for (auto child : node->children) {
-            int value = minimax(child, ia_player, humanPlayer, depth + 1, maxDepth, fuerza_bruta);
-            minValue = std::min(minValue, value);
+        // Profundizacion iterativa: cada iteracion da el valor esperado y la
+        // jugada que se prueba primero en la siguiente
+        int targetDepth = ctx.fuerza_bruta ? BOARD_SIZE * BOARD_SIZE : ctx.maxDepth;
+        bool fuerza_bruta = ctx.fuerza_bruta;
+        ctx.fuerza_bruta = false;
+
+        for (int depth = 1; depth <= targetDepth; depth++) {
+            TRACE_SCOPE_ARG("iteracion", "profundidad", depth);
+            ctx.maxDepth = depth;
+            // La ultima iteracion de fuerza bruta busca hasta el final
+            if (fuerza_bruta && depth == targetDepth) {
+                ctx.fuerza_bruta = true;
+            }
+
+            SearchResult iteration;
+            if (driver == DRIVER_MTDF) {
+                iteration = mtdfIteration(ctx, rootMoves, (depth == 1) ? 0 : result.value);
+            } else if (depth == 1) {
+                iteration = searchRootWindow(ctx, rootMoves, -SEARCH_INFINITY, SEARCH_INFINITY, true);
+            } else {
+                iteration = aspirationIteration(ctx, rootMoves, result.value, aspirationWindow);
+            }
+
+            // Una iteracion incompleta solo sirve si no habia ninguna antes
+            if (searchExhausted(ctx) && isSquareValid(result.bestMove)) {
+                break;
+            }
+            result = iteration;
+            result.depth = depth;
+            if (searchExhausted(ctx) || !isSquareValid(result.bestMove)) {
+                break;
+            }
+            moveToFront(rootMoves, result.bestMove);
+
+            // En fuerza bruta se salta directo al final despues de unas
+            // iteraciones cortas que solo ordenan la raiz
+            if (fuerza_bruta && depth >= 2 && depth < targetDepth - 1) {
+                depth = targetDepth - 1;
+            }
         }
-        
-        node->value = minValue;
-        return minValue;
     }
+
+    result.nodes = ctx.nodesExplored;
+    result.probCutCuts = ctx.probCutCuts;
+    result.endgameHits = ctx.endgameHits;
+    result.stabilityCuts = ctx.stabilityCuts;
+    result.evalCacheProbes = ctx.evalCacheProbes;
+    result.evalCacheHits = ctx.evalCacheHits;
+    result.outOfTime = ctx.outOfTime;
+    return result;
 }
 
-// Obtiene el mejor movimiento usando Minimax
-Square getBestMove(GameModel &model) {
+// Tabla de transposicion compartida entre jugadas
+static TranspositionTable g_tt;
 
-    // Guardar referencia al modelo para las llamadas a drawView()
-    g_currentModel = &model;
-    
-    // Resetear el contador al inicio
-    g_drawViewCounter = 0;
+// Finales resueltos, compartidos entre jugadas y entre partidas
+static EndgameCache g_endgameCache;
+
+// Los procesos trabajadores no abren el archivo de la cache de finales
+static bool g_privateEndgameCache = false;
+
+// Evaluaciones de hojas, compartidas entre jugadas, hilos y partidas
+static EvalCache g_evalCache;
+
+// Red de eval.nnue_file
+static NnueNetwork g_nnue;
+static bool g_nnueLoaded = false;
+
+static void initSearchContext(SearchContext &ctx, tree_logic const& state, Player ia_player) {
+    ctx.state = state;
+    ctx.undo.size = 0;
+    ctx.ia_player = ia_player;
+    ctx.weights = getConfig().weights;
+    ctx.stage = STAGE_MIDGAME;
+    ctx.maxDepth = 0;
+    ctx.fuerza_bruta = false;
+    ctx.nodesExplored = 0;
+    ctx.maxNodes = INT_MAX;
+    ctx.deadline = 0;
+    ctx.outOfTime = false;
+    ctx.probCut = nullptr;
+    ctx.probCutThreshold = 0;
+    ctx.inProbCut = false;
+    ctx.probCutCuts = 0;
+    ctx.tt = isTranspositionTableEnabled(g_tt) ? &g_tt : nullptr;
+    ctx.hash = zobristHash(state);
+    ctx.endgame = isEndgameCacheOpen(g_endgameCache) ? &g_endgameCache : nullptr;
+    ctx.endgameMinEmpties = getConfig().endgameCacheMinEmpties;
+    ctx.endgameMaxEmpties = getConfig().endgameCacheMaxEmpties;
+    ctx.endgameHits = 0;
+    ctx.stabilityCuts = 0;
+    ctx.evalCache = isEvalCacheEnabled(g_evalCache) ? &g_evalCache : nullptr;
+    ctx.evalCacheProbes = 0;
+    ctx.evalCacheHits = 0;
+    ctx.progressModel = nullptr;
+    ctx.progressCounter = 0;
+    ctx.stop = nullptr;
+    ctx.splitPool = nullptr;
+    ctx.split = nullptr;
+    ctx.splitNodes = nullptr;
+    ctx.splitNodesFlushed = 0;
+    ctx.splitMinEmpties = getConfig().endgameSplitMinEmpties;
+    ctx.nnue = g_nnueLoaded ? &g_nnue : nullptr;
+    ctx.nnueTop = 0;
+    if (ctx.nnue != nullptr) {
+        resetNnueAccumulator(g_nnue, state, ctx.nnueStack[0]);
+    }
+}
+
+// Parametros de ProbCut cargados de probcut.params_file
+static ProbCutTable g_probCutTable;
+static bool g_probCutLoaded = false;
+
+// Recarga la configuracion si cambio en disco y, si hay una nueva version,
+// vuelve a leer el libro de aperturas y los parametros de ProbCut.
+static void refreshConfig() {
+    static int loadedVersion = -1;
+
+    reloadConfigIfChanged();
+    if (loadedVersion == getConfigVersion()) {
+        return;
+    }
+    loadedVersion = getConfigVersion();
+
+    AIConfig const& config = getConfig();
+    loadActiveBook(config);
+
+    // Los pesos pueden haber cambiado: los valores guardados ya no sirven
+    initTranspositionTable(g_tt, config.ttSizeMB, config.ttHugePages);
+    initEvalCache(g_evalCache, config.evalCacheKB);
+
+    // Los resultados exactos no dependen de la configuracion: con archivo se
+    // conservan al volver a abrirla
+    closeEndgameCache(g_endgameCache);
+    openEndgameCache(g_endgameCache, config.endgameCacheMB,
+                     g_privateEndgameCache ? "" : config.endgameCachePath.c_str());
+    if (config.threads > 1) {
+        shareEndgameCache(g_endgameCache);
+    }
+
+    if (!openTrace(config.tracePath.c_str())) {
+        printf("No se pudo abrir la traza %s%s\n", config.tracePath.c_str(),
+               isTraceCompiled() ? "" : ": compilar con EDAVERSI_TRACE");
+    }
+
+    g_nnueLoaded = false;
+    if (!config.nnuePath.empty()) {
+        g_nnueLoaded = loadNnue(config.nnuePath.c_str(), g_nnue);
+        if (!g_nnueLoaded) {
+            printf("No se pudo leer la red %s, se usa la evaluacion lineal\n", config.nnuePath.c_str());
+        }
+    }
+
+    g_probCutLoaded = false;
+    if (config.probCut) {
+        g_probCutLoaded = loadProbCutTable(config.probCutPath.c_str(), g_probCutTable);
+        if (!g_probCutLoaded) {
+            printf("No se pudo leer %s, ProbCut desactivado\n", config.probCutPath.c_str());
+        }
+    }
+}
+
+// Fuerza bruta con varios hilos: en vez de ayudantes Lazy SMP, los hilos
+// toman hijos de los nodos divididos mientras dura la busqueda
+static SearchResult searchRootSplit(SearchContext &ctx, SearchDriver driver, int aspirationWindow,
+                                    int threads) {
+    SplitPool pool;
+    pool.stopping = false;
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back(runSplitWorker, &pool);
+    }
+
+    ctx.splitPool = &pool;
+    SearchResult result = searchRoot(ctx, driver, aspirationWindow);
+    ctx.splitPool = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.stopping = true;
+    }
+    pool.wakeup.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    return result;
+}
+
+// Lazy SMP: los ayudantes buscan la misma raiz sin coordinarse y solo
+// comparten la tabla de transposicion (y la cache de finales). Lo que guardan
+// adelanta al hilo principal, que es el unico que decide la jugada. Uno de
+// cada dos ayudantes, empezando por el primero (indices pares de helpers),
+// busca un nivel mas para no repetir el mismo arbol.
+static SearchResult searchRootThreads(SearchContext &ctx, SearchDriver driver, int aspirationWindow,
+                                      int threads) {
+    if (threads > 1 && ctx.fuerza_bruta) {
+        return searchRootSplit(ctx, driver, aspirationWindow, threads);
+    }
+    if (threads <= 1 || ctx.tt == nullptr) {
+        return searchRoot(ctx, driver, aspirationWindow);
+    }
+
+    std::atomic<bool> stop(false);
+    std::vector<SearchContext> helpers(threads - 1, ctx);
+    std::vector<std::thread> workers;
+
+    for (size_t i = 0; i < helpers.size(); i++) {
+        SearchContext &helper = helpers[i];
+        helper.progressModel = nullptr;
+        helper.maxNodes = INT_MAX;
+        helper.stop = &stop;
+        if (i % 2 == 0 && !helper.fuerza_bruta) {
+            helper.maxDepth++;
+        }
+        workers.emplace_back([&helper, driver, aspirationWindow] {
+            searchRoot(helper, driver, aspirationWindow);
+        });
+    }
+
+    SearchResult result = searchRoot(ctx, driver, aspirationWindow);
+
+    stop = true;
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    for (auto const& helper : helpers) {
+        result.nodes += helper.nodesExplored;
+        result.evalCacheProbes += helper.evalCacheProbes;
+        result.evalCacheHits += helper.evalCacheHits;
+    }
+    return result;
+}
+
+void setSearchProgressCallback(SearchProgressCallback callback) {
+    g_progressCallback = callback;
+}
+
+SearchResult searchPosition(tree_logic const& state, Player ia_player, int maxDepth,
+                            ProbCutTable const* probCut) {
+    refreshConfig();
+
+    SearchContext ctx;
+    initSearchContext(ctx, state, ia_player);
+
+    int empty_places = BOARD_SIZE * BOARD_SIZE - (getScore(state, PLAYER_BLACK) + getScore(state, PLAYER_WHITE));
+    ctx.stage = getGameStage(getConfig(), empty_places);
+    ctx.maxDepth = maxDepth;
+    ctx.fuerza_bruta = (maxDepth <= 0);
+    ctx.probCut = probCut;
+    ctx.probCutThreshold = getConfig().probCutThreshold;
+
+    SearchResult result = searchRootThreads(ctx, getConfig().driver, getConfig().aspirationWindow,
+                                            getConfig().threads);
+    flushTrace();
+    return result;
+}
+
+SearchResult searchMove(tree_logic const& state, Player ia_player, Square move, int maxDepth,
+                        int alpha, int beta, std::atomic<bool> const* stop) {
+    SearchContext ctx;
+    initSearchContext(ctx, state, ia_player);
+
+    int empty_places = BOARD_SIZE * BOARD_SIZE - (getScore(state, PLAYER_BLACK) + getScore(state, PLAYER_WHITE));
+    ctx.stage = getGameStage(getConfig(), empty_places);
+    ctx.maxDepth = maxDepth;
+    ctx.fuerza_bruta = (maxDepth <= 0);
+    ctx.stop = stop;
+
+    SearchResult result;
+    memset(&result, 0, sizeof(result));
+    result.bestMove = move;
+
+    ctx.nodesExplored++;
+    playChild(ctx, move);
+    result.value = minimax(ctx, move, 1, alpha, beta);
+    result.outOfTime = searchExhausted(ctx);
+    result.depth = ctx.fuerza_bruta ? 0 : ctx.maxDepth;
+    result.nodes = ctx.nodesExplored;
+    result.endgameHits = ctx.endgameHits;
+    result.stabilityCuts = ctx.stabilityCuts;
+    result.evalCacheProbes = ctx.evalCacheProbes;
+    result.evalCacheHits = ctx.evalCacheHits;
+    return result;
+}
+
+void prepareSearch() {
+    refreshConfig();
+}
+
+void clearSearchTable() {
+    refreshConfig();
+    clearTranspositionTable(g_tt);
+}
+
+void prepareWorkerSearch() {
+    // El mapeo heredado del padre se suelta sin tocar el archivo
+    g_privateEndgameCache = true;
+    if (g_endgameCache.mapping != nullptr) {
+        closeEndgameCache(g_endgameCache);
+        openEndgameCache(g_endgameCache, getConfig().endgameCacheMB, "");
+    }
+    refreshConfig();
+}
+
+void prepareSharedSearch() {
+    refreshConfig();
+    shareEndgameCache(g_endgameCache);
+}
+
+// Busca la jugada de la IA en una partida: libro de aperturas o busqueda con
+// los limites de la etapa. No recarga nada, asi que se puede llamar desde
+// varios hilos con tablas distintas.
+static SearchResult searchGame(GameModel const& model, TranspositionTable* tt, bool useEndgameCache,
+                               double remainingTime, int threads, GameModel* progressModel,
+                               bool &fromBook) {
+    TRACE_SCOPE("searchGame");
+    AIConfig const& config = getConfig();
+
+    SearchResult result;
+    memset(&result, 0, sizeof(result));
 
     // 1) Intentar jugar de libro de aperturas
-    Square bookMove;
-    if (openingBookBestMove(model, bookMove)) {
-        g_currentModel = nullptr; // Limpiar la referencia
-        return bookMove;
+    {
+        TRACE_SCOPE("libro");
+        fromBook = openingBookBestMove(model, result.bestMove);
     }
-    
+    if (fromBook) {
+        return result;
+    }
+
     Player ia_player = (model.humanPlayer == PLAYER_WHITE) ? PLAYER_BLACK : PLAYER_WHITE;
 
-    int maxDepth = 5;       
-    int g_maxNodes = 50000;  
-    int g_nodesExplored = 0;
-    bool fuerza_bruta = false;
-    
+    int empty_places = BOARD_SIZE * BOARD_SIZE - (getScore(model.tree, ia_player) + getScore(model.tree, model.humanPlayer));
+    GameStage stage = getGameStage(config, empty_places);
+    StageConfig const& stageConfig = config.stages[stage];
+
+    SearchContext ctx;
+    initSearchContext(ctx, model.tree, ia_player);
+    ctx.tt = isTranspositionTableEnabled(*tt) ? tt : nullptr;
+    if (!useEndgameCache) {
+        ctx.endgame = nullptr;
+    }
+    ctx.stage = stage;
+    ctx.maxDepth = stageConfig.maxDepth;
+    ctx.fuerza_bruta = (stageConfig.maxDepth <= 0);
+    ctx.maxNodes = config.maxNodes;
+    ctx.progressModel = progressModel;
+    if (config.probCut && g_probCutLoaded) {
+        ctx.probCut = &g_probCutTable;
+        ctx.probCutThreshold = config.probCutThreshold;
+    }
+
+    // Parte del tiempo que queda en la partida segun la etapa
+    if (remainingTime >= 0) {
+        ctx.deadline = searchClock() + remainingTime * stageConfig.timeShare;
+    }
+
+    newSearchGeneration(*tt);
+    return searchRootThreads(ctx, config.driver, config.aspirationWindow, threads);
+}
+
+SearchResult getGameBestMove(GameModel const& model, TranspositionTable &tt, double remainingTime) {
+    bool fromBook;
+    SearchResult result = searchGame(model, &tt, true, remainingTime, 1, nullptr, fromBook);
+    flushTrace();
+    return result;
+}
+
+// Agrega la decision al registro, con la configuracion si es la primera
+// decision tomada con ella
+static void recordDecision(GameModel const& model, Player ia_player, double remainingTime,
+                           SearchResult const& result, bool fromBook, double seconds) {
+    static int recordedVersion = -1;
+    const char *path = getConfig().recordPath.c_str();
+
+    if (recordedVersion != getConfigVersion()) {
+        std::map<std::string, std::string> values;
+        getConfigValues(getConfig(), values);
+        if (!appendDecisionConfig(path, getConfigVersion(), values)) {
+            printf("No se pudo grabar en %s\n", path);
+            return;
+        }
+        recordedVersion = getConfigVersion();
+    }
+
+    DecisionRecord record;
+    record.config = recordedVersion;
+    record.state = model.tree;
+    record.aiPlayer = ia_player;
+    record.remainingTime = remainingTime;
+    record.result = result;
+    record.seconds = seconds;
+    record.book = fromBook;
+    if (!appendDecision(path, record)) {
+        printf("No se pudo grabar en %s\n", path);
+    }
+}
+
+// Obtiene el mejor movimiento usando Minimax
+Square getBestMove(GameModel &model) {
+
+    refreshConfig();
+    AIConfig const& config = getConfig();
+
+    Player ia_player = (model.humanPlayer == PLAYER_WHITE) ? PLAYER_BLACK : PLAYER_WHITE;
     int empty_places = BOARD_SIZE * BOARD_SIZE - (getScore(model, ia_player) + getScore(model, model.humanPlayer));
-    
-    if(empty_places <= 8){
-        fuerza_bruta = true;
+    GameStage stage = getGameStage(config, empty_places);
+
+    if (config.stages[stage].maxDepth <= 0) {
         printf("Modo fuerza bruta activado. Casillas vacías: %d\n", empty_places);
-    } else if(empty_places <= 14) {
-        maxDepth = 7;
     }
 
-    tree_logic current_state = gameStateFromModel(model);
-    
-    std::vector<treeNode*> gameTree;
-    init_tree(current_state, gameTree, 0, maxDepth, g_nodesExplored, g_maxNodes, fuerza_bruta);
+    double remaining = -1;
+    if (config.timeBudget > 0) {
+        remaining = std::max(0.0, config.timeBudget - model.playerTime[ia_player]);
+    }
 
-    if (gameTree.empty()) {
-        g_currentModel = nullptr; // Limpiar la referencia
-        return GAME_INVALID_SQUARE;
+    // Grabando, cada busqueda empieza de cero y con un solo hilo para poder
+    // repetirla igual
+    bool recording = !config.recordPath.empty();
+    if (recording) {
+        clearTranspositionTable(g_tt);
     }
 
-    int bestValue = -1000;
-    Square bestMove = GAME_INVALID_SQUARE;
-    
-    for (auto node : gameTree) {
-        int value = minimax(node, ia_player, model.humanPlayer, 0, maxDepth, fuerza_bruta);
-        
-        if (value > bestValue) {
-            bestValue = value;
-            bestMove = node->square;
-        }
+    bool fromBook;
+    double start = searchClock();
+    SearchResult result = searchGame(model, &g_tt, !recording, remaining,
+                                     recording ? 1 : config.threads, &model, fromBook);
+    flushTrace();
+    if (recording) {
+        recordDecision(model, ia_player, remaining, result, fromBook, searchClock() - start);
     }
+    if (fromBook) {
+        printf("Jugada de libro: %s\n", toAlg(result.bestMove).c_str());
+        return result.bestMove;
+    }
+
+    printf("Nodos explorados: %d, Mejor valor: %d, Profundidad: %d, Casillas vacías: %d, Cortes ProbCut: %d, Finales en cache: %d, Cortes por estabilidad: %d, Evaluaciones en cache: %d/%d\n",
+           result.nodes, result.value, result.depth, empty_places, result.probCutCuts, result.endgameHits,
+           result.stabilityCuts, result.evalCacheHits, result.evalCacheProbes);
     
-    printf("Nodos explorados: %d, Mejor valor: %d, Casillas vacías: %d\n", g_nodesExplored, bestValue, empty_places);
-    free_tree(gameTree);
-    
-    // Calcular movimientos válidos y llamada final para actualizar la UI
-    Moves validMoves;
-    getValidMoves(model, validMoves);
-    drawView(model, validMoves);
-    
-    // Limpiar la referencia al modelo
-    g_currentModel = nullptr;
+    // Llamada final para actualizar la UI
+    if (g_progressCallback != nullptr) {
+        drawProgress(model);
+    }
     
-    return bestMove;
+    return result.bestMove;
 }
\ No newline at end of file
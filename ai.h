@@ -8,15 +8,136 @@
 #ifndef AI_H
 #define AI_H
 
+#include <atomic>
+
 #include "model.h"
+#include "probcut.h"
+#include "transposition.h"
+
+#define SEARCH_INFINITY 1000000
+
+// Valor de cada ficha de diferencia en una partida terminada: cualquier
+// resultado conocido pesa mas que la evaluacion de una posicion abierta
+#define FINAL_DISC_VALUE 1000
 
-struct treeNode {
-    Square square;
-    tree_logic state;  // Para copiar el estado esencial, no GameModel completo
-    std::vector<treeNode*> children;
+struct SearchResult
+{
+    Square bestMove;
     int value;
+    int depth;                  // profundidad completada, 0 = hasta el final
+    int nodes;
+    int probCutCuts;
+    int endgameHits;            // posiciones resueltas por la cache de finales
+    int stabilityCuts;          // podas por fichas estables en fuerza bruta
+    int evalCacheProbes;        // hojas buscadas en la cache de evaluaciones
+    int evalCacheHits;
+    bool outOfTime;             // cortada por el limite de tiempo: no se puede repetir igual
 };
 
+typedef void (*SearchProgressCallback)(GameModel &model);
+
+/**
+ * @brief Sets the function called periodically while the AI searches,
+ *        so the view keeps responding.
+ *
+ * @param callback The function, or nullptr.
+ */
+void setSearchProgressCallback(SearchProgressCallback callback);
+
+/**
+ * @brief Searches a position to a fixed depth, without opening book,
+ *        node cap or time limit.
+ *
+ * @param state The tree logic state.
+ * @param ia_player The player whose value is maximized.
+ * @param maxDepth The depth in plies, 0 searches until the end.
+ * @param probCut ProbCut parameters, or nullptr to search full width.
+ * @return The best move, its value and search statistics.
+ */
+SearchResult searchPosition(tree_logic const& state, Player ia_player, int maxDepth,
+                            ProbCutTable const* probCut);
+
+/**
+ * @brief Searches one root move of a position with a window, as the root of
+ *        searchPosition does with the plain driver. Values are fail-soft: at
+ *        most alpha means the move is not better than alpha. Uses the
+ *        configuration already loaded, so it can run on another thread:
+ *        call prepareSearch first.
+ *
+ * @param state The tree logic state.
+ * @param ia_player The player whose value is maximized.
+ * @param move A valid move of state.
+ * @param maxDepth The depth in plies counting the move, 0 searches until the end.
+ * @param alpha The lower bound of the window.
+ * @param beta The upper bound of the window.
+ * @param stop Set by another thread to abandon the search, or nullptr.
+ * @return The move, its value and search statistics. outOfTime is set if
+ *         the search was stopped and the value cannot be used.
+ */
+SearchResult searchMove(tree_logic const& state, Player ia_player, Square move, int maxDepth,
+                        int alpha, int beta, std::atomic<bool> const* stop);
+
+/**
+ * @brief Evaluates a leaf of the search.
+ *
+ * @param model The tree logic state.
+ * @param ia_player The player whose value is maximized.
+ * @param move The move that led to the state.
+ * @param weights The evaluation weights.
+ * @return The value.
+ */
+int value_state(tree_logic &model, Player ia_player, Square move, EvalWeights const& weights);
+
+/**
+ * @brief Looks up the opening book, which is loaded by the first search.
+ *
+ * @param model The game model.
+ * @param outMove Receives the book move.
+ * @return The position is in the book and its move is valid.
+ */
+bool openingBookBestMove(const GameModel& model, Square& outMove);
+
+/**
+ * @brief Reloads the configuration if it changed, with the opening book,
+ *        tables and network. Call it from the main thread while no search
+ *        is running.
+ */
+void prepareSearch();
+
+/**
+ * @brief Empties the transposition table of searchPosition and searchMove,
+ *        so the next search does not reuse the values of the previous one.
+ */
+void clearSearchTable();
+
+/**
+ * @brief Like prepareSearch, for a forked process: the endgame cache stays
+ *        in memory and never maps the file, whose entries other processes
+ *        could be writing.
+ */
+void prepareWorkerSearch();
+
+/**
+ * @brief Loads what every search shares: configuration, opening book,
+ *        ProbCut parameters and endgame cache, which becomes safe to use from
+ *        several threads. Call it once before searching with getGameBestMove.
+ */
+void prepareSharedSearch();
+
+/**
+ * @brief Gets the best move for the AI player of a game, using the game's own
+ *        transposition table. It does not reload the configuration nor draw
+ *        progress, so games can be searched at the same time from different
+ *        threads.
+ *
+ * @param model The game model.
+ * @param tt The game's transposition table.
+ * @param remainingTime Seconds left for the AI in the game, negative for no limit.
+ * @return The best move and search statistics (only bestMove for book moves).
+ *         The search uses a single thread whatever search.threads says.
+ */
+SearchResult getGameBestMove(GameModel const &model, TranspositionTable &tt, double remainingTime);
+
 /**
  * @brief Gets the best move for the AI player.
  *
@@ -0,0 +1,313 @@
+/**
+ * @brief Analysis of a position split across worker processes
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "analysis.h"
+
+// Intentos por jugada antes de abandonar el analisis
+#define ANALYSIS_MAX_ATTEMPTS 3
+
+static std::string formatSquare(Square square)
+{
+    std::string text;
+    text += (char)('A' + square.x);
+    text += (char)('1' + square.y);
+    return text;
+}
+
+static std::string formatBoard(tree_logic const&state)
+{
+    std::string board;
+    for (int y = 0; y < BOARD_SIZE; y++)
+        for (int x = 0; x < BOARD_SIZE; x++)
+        {
+            Piece piece = state.board[y][x];
+            board += (piece == PIECE_BLACK) ? 'X' : (piece == PIECE_WHITE) ? 'O' : '-';
+        }
+    return board;
+}
+
+static bool parseTask(const char *line, int &id, tree_logic &state, Player &ia_player,
+                      Square &move, int &maxDepth, int &alpha)
+{
+    char board[BOARD_SIZE * BOARD_SIZE + 1], turn, ia, square[3];
+
+    if (sscanf(line, "buscar %d %64s %c %c %2s %d %d", &id, board, &turn, &ia, square,
+               &maxDepth, &alpha) != 7 ||
+        strlen(board) != BOARD_SIZE * BOARD_SIZE)
+        return false;
+
+    for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++)
+        state.board[i / BOARD_SIZE][i % BOARD_SIZE] =
+            (board[i] == 'X') ? PIECE_BLACK : (board[i] == 'O') ? PIECE_WHITE : PIECE_EMPTY;
+    state.currentPlayer = (turn == 'X') ? PLAYER_BLACK : PLAYER_WHITE;
+    state.gameOver = false;
+    ia_player = (ia == 'X') ? PLAYER_BLACK : PLAYER_WHITE;
+    move = {square[0] - 'A', square[1] - '1'};
+    return isSquareValid(move);
+}
+
+static bool writeAll(int fd, std::string const&text)
+{
+    size_t written = 0;
+    while (written < text.size())
+    {
+        ssize_t count = write(fd, text.data() + written, text.size() - written);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            return false;
+        written += count;
+    }
+    return true;
+}
+
+// Proceso trabajador: busca lo que le piden hasta que el coordinador cierra
+static void runAnalysisWorker(int fd)
+{
+    FILE *input = fdopen(fd, "r");
+    char line[256];
+
+    prepareWorkerSearch();
+
+    while (input != nullptr && fgets(line, sizeof(line), input))
+    {
+        int id, maxDepth, alpha;
+        tree_logic state;
+        Player ia_player;
+        Square move;
+        if (!parseTask(line, id, state, ia_player, move, maxDepth, alpha))
+            break;
+
+        SearchResult result = searchMove(state, ia_player, move, maxDepth, alpha, SEARCH_INFINITY, nullptr);
+        if (!writeAll(fd, "valor " + std::to_string(id) + " " + std::to_string(result.value) + " " +
+                              std::to_string(result.nodes) + "\n"))
+            break;
+    }
+    _exit(0);
+}
+
+static bool spawnWorker(AnalysisCluster &cluster, AnalysisWorker &worker)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        return false;
+
+    // Lo que quede en el buffer se imprimiria dos veces
+    fflush(stdout);
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0)
+    {
+        // Sin los extremos de los demas, el cierre del coordinador llega como EOF
+        close(fds[0]);
+        for (auto const&other : cluster.workers)
+            if (other.fd >= 0)
+                close(other.fd);
+        runAnalysisWorker(fds[1]);
+    }
+
+    close(fds[1]);
+    worker.pid = pid;
+    worker.fd = fds[0];
+    worker.input.clear();
+    worker.task = -1;
+    return true;
+}
+
+bool startAnalysisCluster(AnalysisCluster &cluster, int workers)
+{
+    // Escribir a un trabajador muerto es un error, no una senal
+    signal(SIGPIPE, SIG_IGN);
+
+    cluster.workers.clear();
+    cluster.workers.reserve(workers);
+    cluster.deaths = 0;
+
+    for (int i = 0; i < workers; i++)
+    {
+        AnalysisWorker worker;
+        worker.fd = -1;
+        if (!spawnWorker(cluster, worker))
+            return false;
+        cluster.workers.push_back(worker);
+    }
+    return true;
+}
+
+static void closeWorker(AnalysisWorker &worker)
+{
+    if (worker.fd < 0)
+        return;
+
+    close(worker.fd);
+    worker.fd = -1;
+    waitpid(worker.pid, nullptr, 0);
+}
+
+void stopAnalysisCluster(AnalysisCluster &cluster)
+{
+    for (auto &worker : cluster.workers)
+        closeWorker(worker);
+    cluster.workers.clear();
+}
+
+struct AnalysisTask
+{
+    int alpha;                  // alpha con la que se entrego
+};
+
+bool analyzePosition(AnalysisCluster &cluster, tree_logic const&state, Player ia_player,
+                     int maxDepth, std::vector<MoveAnalysis> &moves)
+{
+    Moves valid;
+    getValidMoves(state, valid);
+
+    moves.clear();
+    for (auto move : valid)
+        moves.push_back(MoveAnalysis{move, -SEARCH_INFINITY, false, 0, 0});
+    if (moves.empty() || cluster.workers.empty())
+        return false;
+
+    // La mejor de una busqueda corta va primero y sola: su valor es la
+    // alpha con la que se descartan las demas
+    int shallow = (maxDepth > 0) ? std::min(maxDepth - 1, 4) : 4;
+    if (shallow >= 1 && moves.size() > 1)
+    {
+        Square first = searchPosition(state, ia_player, shallow, nullptr).bestMove;
+        for (size_t i = 1; i < moves.size(); i++)
+            if (moves[i].move.x == first.x && moves[i].move.y == first.y)
+                std::swap(moves[0], moves[i]);
+    }
+
+    std::deque<int> pending;
+    for (size_t i = 0; i < moves.size(); i++)
+        pending.push_back((int)i);
+
+    std::vector<AnalysisTask> tasks(moves.size());
+    std::string board = formatBoard(state);
+    char turn = (state.currentPlayer == PLAYER_BLACK) ? 'X' : 'O';
+    char ia = (ia_player == PLAYER_BLACK) ? 'X' : 'O';
+    int alpha = -SEARCH_INFINITY;
+    size_t done = 0;
+    bool firstDone = false;
+
+    while (done < moves.size())
+    {
+        // Entregar jugadas a los trabajadores libres
+        for (auto &worker : cluster.workers)
+        {
+            if (pending.empty() || (!firstDone && pending.front() != 0))
+                break;
+            if (worker.fd < 0 || worker.task >= 0)
+                continue;
+
+            int id = pending.front();
+            pending.pop_front();
+            moves[id].attempts++;
+            tasks[id].alpha = alpha;
+            worker.task = id;
+
+            std::string line = "buscar " + std::to_string(id) + " " + board + " " + turn + " " + ia + " " +
+                               formatSquare(moves[id].move) + " " + std::to_string(maxDepth) + " " +
+                               std::to_string(alpha) + "\n";
+            if (!writeAll(worker.fd, line))
+                shutdown(worker.fd, SHUT_RDWR);     // el poll lo ve como muerto
+        }
+
+        std::vector<pollfd> fds;
+        std::vector<size_t> owners;
+        for (size_t i = 0; i < cluster.workers.size(); i++)
+            if (cluster.workers[i].fd >= 0 && cluster.workers[i].task >= 0)
+            {
+                fds.push_back(pollfd{cluster.workers[i].fd, POLLIN, 0});
+                owners.push_back(i);
+            }
+        if (fds.empty())
+            return false;
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        for (size_t i = 0; i < fds.size(); i++)
+        {
+            if (fds[i].revents == 0)
+                continue;
+            AnalysisWorker &worker = cluster.workers[owners[i]];
+
+            char buffer[256];
+            ssize_t count = read(worker.fd, buffer, sizeof(buffer));
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count <= 0)
+            {
+                // Murio: su jugada vuelve a la cola y otro proceso lo reemplaza
+                int id = worker.task;
+                printf("Trabajador %d murio buscando %s\n", (int)worker.pid,
+                       formatSquare(moves[id].move).c_str());
+                closeWorker(worker);
+                cluster.deaths++;
+
+                if (moves[id].attempts >= ANALYSIS_MAX_ATTEMPTS)
+                    return false;
+                pending.push_front(id);
+                spawnWorker(cluster, worker);
+                continue;
+            }
+
+            worker.input.append(buffer, count);
+            size_t end;
+            while ((end = worker.input.find('\n')) != std::string::npos)
+            {
+                std::string line = worker.input.substr(0, end);
+                worker.input.erase(0, end + 1);
+
+                int id, value, nodes;
+                if (sscanf(line.c_str(), "valor %d %d %d", &id, &value, &nodes) != 3 ||
+                    id != worker.task)
+                    continue;
+
+                moves[id].value = value;
+                moves[id].exact = (value > tasks[id].alpha);
+                moves[id].nodes += nodes;
+                alpha = std::max(alpha, value);
+                worker.task = -1;
+                firstDone = true;
+                done++;
+            }
+        }
+    }
+
+    // Las exactas primero, de mayor a menor; las cotas despues
+    std::stable_sort(moves.begin(), moves.end(), [](MoveAnalysis const&a, MoveAnalysis const&b) {
+        if (a.exact != b.exact)
+            return a.exact;
+        return a.value > b.value;
+    });
+    return true;
+}
@@ -0,0 +1,81 @@
+/**
+ * @brief Analysis of a position split across worker processes
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+#include "ai.h"
+#include "model.h"
+
+// Cada trabajador es un proceso hijo con su propia tabla de transposicion y
+// su propia cache de finales en memoria, conectado por un socketpair. Una
+// linea de texto por mensaje:
+//   coordinador -> trabajador: buscar <id> <tablero> <turno> <ia> <jugada> <profundidad> <alpha>
+//   trabajador -> coordinador: valor <id> <valor> <nodos>
+// El tablero son 64 casillas de A1 a H8 por filas: X negras, O blancas, - vacia.
+
+struct AnalysisWorker
+{
+    pid_t pid;
+    int fd;                     // extremo del coordinador, -1 = muerto
+    std::string input;          // lo leido que todavia no forma una linea
+    int task;                   // jugada que esta buscando, -1 = libre
+};
+
+struct MoveAnalysis
+{
+    Square move;
+    int value;
+    bool exact;                 // si no, value es una cota superior (corte)
+    int nodes;
+    int attempts;               // veces que se entrego a un trabajador
+};
+
+struct AnalysisCluster
+{
+    std::vector<AnalysisWorker> workers;
+    int deaths;                 // trabajadores muertos y reemplazados
+};
+
+/**
+ * @brief Forks the worker processes. Load the configuration first: workers
+ *        inherit it.
+ *
+ * @param cluster The cluster.
+ * @param workers The amount of processes.
+ * @return All workers started.
+ */
+bool startAnalysisCluster(AnalysisCluster &cluster, int workers);
+
+/**
+ * @brief Closes the connections and waits for the workers to exit.
+ *
+ * @param cluster The cluster.
+ */
+void stopAnalysisCluster(AnalysisCluster &cluster);
+
+/**
+ * @brief Searches every move of a position on the workers. The first move
+ *        is searched alone; the rest get the best value so far as alpha,
+ *        so weaker moves come back as bounds. A move whose worker dies goes
+ *        to another worker, which replaces the dead one.
+ *
+ * @param cluster The cluster.
+ * @param state The position, with moves for the side to move.
+ * @param ia_player The player whose value is maximized.
+ * @param maxDepth The depth in plies, 0 searches until the end.
+ * @param moves Receives the value of every move, best first.
+ * @return Every move was searched.
+ */
+bool analyzePosition(AnalysisCluster &cluster, tree_logic const &state, Player ia_player,
+                     int maxDepth, std::vector<MoveAnalysis> &moves);
+
+#endif
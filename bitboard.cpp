@@ -0,0 +1,263 @@
+/**
+ * @brief Bitboard helpers for the Reversi game AI
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include "bitboard.h"
+
+static_assert(BOARD_SIZE == 8, "Los bitboards asumen un tablero de 8x8");
+
+#define NOT_COLUMN_A 0xfefefefefefefefeULL
+#define NOT_COLUMN_H 0x7f7f7f7f7f7f7f7fULL
+
+// Desplaza todo el tablero una casilla en una de las 8 direcciones,
+// descartando lo que se sale por los costados
+static inline uint64_t shiftDirection(uint64_t bits, int direction)
+{
+    switch (direction)
+    {
+    case 0: return (bits << 1) & NOT_COLUMN_A;         // x + 1
+    case 1: return (bits >> 1) & NOT_COLUMN_H;         // x - 1
+    case 2: return bits << 8;                          // y + 1
+    case 3: return bits >> 8;                          // y - 1
+    case 4: return (bits << 9) & NOT_COLUMN_A;         // x + 1, y + 1
+    case 5: return (bits << 7) & NOT_COLUMN_H;         // x - 1, y + 1
+    case 6: return (bits >> 7) & NOT_COLUMN_A;         // x + 1, y - 1
+    default: return (bits >> 9) & NOT_COLUMN_H;        // x - 1, y - 1
+    }
+}
+
+void splitBitboard(Bitboard const&board, Player player, uint64_t &own, uint64_t &opponent)
+{
+    own = (player == PLAYER_BLACK) ? board.black : board.white;
+    opponent = (player == PLAYER_BLACK) ? board.white : board.black;
+}
+
+uint64_t getMovesMask(uint64_t own, uint64_t opponent)
+{
+    uint64_t empty = ~(own | opponent);
+    uint64_t moves = 0;
+
+    for (int direction = 0; direction < 8; direction++)
+    {
+        // Cadenas de fichas rivales que empiezan al lado de una propia
+        uint64_t chain = shiftDirection(own, direction) & opponent;
+        for (int i = 0; i < BOARD_SIZE - 3; i++)
+            chain |= shiftDirection(chain, direction) & opponent;
+
+        moves |= shiftDirection(chain, direction) & empty;
+    }
+
+    return moves;
+}
+
+uint64_t getFlipsMask(int square, uint64_t own, uint64_t opponent)
+{
+    uint64_t start = (uint64_t)1 << square;
+    uint64_t flips = 0;
+
+    if ((own | opponent) & start)
+        return 0;
+
+    for (int direction = 0; direction < 8; direction++)
+    {
+        uint64_t line = 0;
+        uint64_t current = shiftDirection(start, direction);
+
+        while (current & opponent)
+        {
+            line |= current;
+            current = shiftDirection(current, direction);
+        }
+
+        if (current & own)
+            flips |= line;
+    }
+
+    return flips;
+}
+
+bool playBitboardMove(Bitboard &board, Player &player, int square)
+{
+    uint64_t own, opponent;
+    splitBitboard(board, player, own, opponent);
+
+    uint64_t flips = getFlipsMask(square, own, opponent);
+    if (!flips)
+        return false;
+
+    own |= flips | ((uint64_t)1 << square);
+    opponent &= ~flips;
+
+    board.black = (player == PLAYER_BLACK) ? own : opponent;
+    board.white = (player == PLAYER_BLACK) ? opponent : own;
+
+    // Si el rival no puede jugar, repite el mismo jugador
+    if (getMovesMask(opponent, own))
+        player = (player == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK;
+
+    return true;
+}
+
+Bitboard getBitboard(tree_logic const&tree)
+{
+    Bitboard board = {0, 0};
+
+    for (int y = 0; y < BOARD_SIZE; y++)
+        for (int x = 0; x < BOARD_SIZE; x++)
+        {
+            uint64_t bit = (uint64_t)1 << (y * BOARD_SIZE + x);
+
+            if (tree.board[y][x] == PIECE_BLACK)
+                board.black |= bit;
+            else if (tree.board[y][x] == PIECE_WHITE)
+                board.white |= bit;
+        }
+
+    return board;
+}
+
+tree_logic getTreeLogic(Bitboard const&board, Player player)
+{
+    tree_logic tree;
+    tree.currentPlayer = player;
+
+    for (int y = 0; y < BOARD_SIZE; y++)
+        for (int x = 0; x < BOARD_SIZE; x++)
+        {
+            uint64_t bit = (uint64_t)1 << (y * BOARD_SIZE + x);
+
+            if (board.black & bit)
+                tree.board[y][x] = PIECE_BLACK;
+            else if (board.white & bit)
+                tree.board[y][x] = PIECE_WHITE;
+            else
+                tree.board[y][x] = PIECE_EMPTY;
+        }
+
+    tree.gameOver = !getMovesMask(board.black, board.white) &&
+                    !getMovesMask(board.white, board.black);
+    return tree;
+}
+
+// Espeja las columnas (x -> 7 - x) con tres delta swaps dentro de cada byte
+static uint64_t mirrorColumns(uint64_t bits)
+{
+    const uint64_t k1 = 0x5555555555555555ULL;
+    const uint64_t k2 = 0x3333333333333333ULL;
+    const uint64_t k4 = 0x0f0f0f0f0f0f0f0fULL;
+
+    bits = ((bits >> 1) & k1) | ((bits & k1) << 1);
+    bits = ((bits >> 2) & k2) | ((bits & k2) << 2);
+    bits = ((bits >> 4) & k4) | ((bits & k4) << 4);
+    return bits;
+}
+
+// Espeja las filas (y -> 7 - y): cada fila es un byte
+static uint64_t mirrorRows(uint64_t bits)
+{
+    return __builtin_bswap64(bits);
+}
+
+// Traspone el tablero (x <-> y) con tres delta swaps
+static uint64_t transpose(uint64_t bits)
+{
+    const uint64_t k1 = 0x5500550055005500ULL;
+    const uint64_t k2 = 0x3333000033330000ULL;
+    const uint64_t k4 = 0x0f0f0f0f00000000ULL;
+    uint64_t t;
+
+    t = k4 & (bits ^ (bits << 28));
+    bits ^= t ^ (t >> 28);
+    t = k2 & (bits ^ (bits << 14));
+    bits ^= t ^ (t >> 14);
+    t = k1 & (bits ^ (bits << 7));
+    bits ^= t ^ (t >> 7);
+    return bits;
+}
+
+uint64_t transformBits(uint64_t bits, int symmetry)
+{
+    if (symmetry & 4)
+        bits = transpose(bits);
+    if (symmetry & 1)
+        bits = mirrorColumns(bits);
+    if (symmetry & 2)
+        bits = mirrorRows(bits);
+    return bits;
+}
+
+Square transformSquare(Square square, int symmetry)
+{
+    if (symmetry & 4)
+        square = {square.y, square.x};
+    if (symmetry & 1)
+        square.x = BOARD_SIZE - 1 - square.x;
+    if (symmetry & 2)
+        square.y = BOARD_SIZE - 1 - square.y;
+    return square;
+}
+
+Square inverseTransformSquare(Square square, int symmetry)
+{
+    if (symmetry & 2)
+        square.y = BOARD_SIZE - 1 - square.y;
+    if (symmetry & 1)
+        square.x = BOARD_SIZE - 1 - square.x;
+    if (symmetry & 4)
+        square = {square.y, square.x};
+    return square;
+}
+
+Bitboard canonicalBitboard(Bitboard board, int &symmetry)
+{
+    Bitboard best = board;
+    symmetry = 0;
+
+    for (int s = 1; s < SYMMETRY_COUNT; s++)
+    {
+        Bitboard candidate = {transformBits(board.black, s),
+                              transformBits(board.white, s)};
+
+        if ((candidate.black < best.black) ||
+            ((candidate.black == best.black) && (candidate.white < best.white)))
+        {
+            best = candidate;
+            symmetry = s;
+        }
+    }
+
+    return best;
+}
+
+// Finalizador de MurmurHash3: mezcla bien los 64 bits con pocas operaciones
+static uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+uint64_t hashBitboard(Bitboard board, Player player)
+{
+    uint64_t hash = mix64(board.black ^ 0x9e3779b97f4a7c15ULL);
+    hash = mix64(hash ^ board.white);
+    return (player == PLAYER_WHITE) ? ~hash : hash;
+}
+
+uint64_t canonicalHash(Bitboard const&board, Player player)
+{
+    int symmetry;
+    return hashBitboard(canonicalBitboard(board, symmetry), player);
+}
+
+uint64_t canonicalHash(tree_logic const&tree, int &symmetry)
+{
+    Bitboard board = canonicalBitboard(getBitboard(tree), symmetry);
+    return hashBitboard(board, tree.currentPlayer);
+}
@@ -0,0 +1,144 @@
+/**
+ * @brief Bitboard helpers for the Reversi game AI
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+
+#include "model.h"
+
+#define SYMMETRY_COUNT 8
+
+// Bit (y * BOARD_SIZE + x) corresponde a la casilla {x, y}, igual que FlipMask
+struct Bitboard
+{
+    uint64_t black;
+    uint64_t white;
+};
+
+/**
+ * @brief Returns the bitboard of the player to move and of the opponent.
+ *
+ * @param board The bitboards.
+ * @param player The player.
+ * @param own Receives the player's discs.
+ * @param opponent Receives the opponent's discs.
+ */
+void splitBitboard(Bitboard const&board, Player player, uint64_t &own, uint64_t &opponent);
+
+/**
+ * @brief Returns all valid moves at once.
+ *
+ * @param own The discs of the player to move.
+ * @param opponent The opponent's discs.
+ * @return One bit per valid move.
+ */
+uint64_t getMovesMask(uint64_t own, uint64_t opponent);
+
+/**
+ * @brief Returns the discs flipped by a move.
+ *
+ * @param square The move (y * BOARD_SIZE + x).
+ * @param own The discs of the player to move.
+ * @param opponent The opponent's discs.
+ * @return The flipped discs, 0 if the move is not valid.
+ */
+uint64_t getFlipsMask(int square, uint64_t own, uint64_t opponent);
+
+/**
+ * @brief Plays a move on bitboards, with the same pass rules as playMove.
+ *
+ * @param board The bitboards.
+ * @param player The player to move, updated after the move.
+ * @param square The move (y * BOARD_SIZE + x).
+ * @return The move was valid; otherwise nothing changes.
+ */
+bool playBitboardMove(Bitboard &board, Player &player, int square);
+
+/**
+ * @brief Packs a board into one bitboard per color.
+ *
+ * @param tree The tree logic state.
+ * @return The bitboards.
+ */
+Bitboard getBitboard(tree_logic const&tree);
+
+/**
+ * @brief Unpacks bitboards into a board.
+ *
+ * @param board The bitboards.
+ * @param player The player to move.
+ * @return The tree logic state, with gameOver set if nobody can move.
+ */
+tree_logic getTreeLogic(Bitboard const&board, Player player);
+
+/**
+ * @brief Applies one of the 8 board symmetries to a bitboard.
+ *        Bit 2 transposes, then bit 0 mirrors columns and bit 1 mirrors rows.
+ *
+ * @param bits The bitboard.
+ * @param symmetry The symmetry (0 to SYMMETRY_COUNT - 1, 0 is the identity).
+ * @return The transformed bitboard.
+ */
+uint64_t transformBits(uint64_t bits, int symmetry);
+
+/**
+ * @brief Applies a board symmetry to a square.
+ *
+ * @param square The square.
+ * @param symmetry The symmetry.
+ * @return The transformed square.
+ */
+Square transformSquare(Square square, int symmetry);
+
+/**
+ * @brief Undoes a board symmetry on a square.
+ *
+ * @param square The transformed square.
+ * @param symmetry The symmetry that was applied.
+ * @return The original square.
+ */
+Square inverseTransformSquare(Square square, int symmetry);
+
+/**
+ * @brief Returns the representative of the symmetry class of a position.
+ *
+ * @param board The bitboards.
+ * @param symmetry Receives the symmetry that maps board to the result.
+ * @return The canonical bitboards.
+ */
+Bitboard canonicalBitboard(Bitboard board, int &symmetry);
+
+/**
+ * @brief Hashes a position.
+ *
+ * @param board The bitboards.
+ * @param player The player to move.
+ * @return The hash.
+ */
+uint64_t hashBitboard(Bitboard board, Player player);
+
+/**
+ * @brief Hashes a position so that all its symmetric positions share the key.
+ *
+ * @param board The bitboards.
+ * @param player The player to move.
+ * @return The hash.
+ */
+uint64_t canonicalHash(Bitboard const&board, Player player);
+
+/**
+ * @brief Hashes a position so that all its symmetric positions share the key.
+ *
+ * @param tree The tree logic state.
+ * @param symmetry Receives the symmetry that maps tree to the canonical position.
+ * @return The hash.
+ */
+uint64_t canonicalHash(tree_logic const&tree, int &symmetry);
+
+#endif
@@ -0,0 +1,291 @@
+/**
+ * @brief Binary opening book built from deep searches
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+
+#include "ai.h"
+#include "book.h"
+#include "gamedb.h"
+
+static_assert(sizeof(BookEntry) == 32, "El formato del libro usa registros de 32 bytes");
+
+void initBook(BookTree &book)
+{
+    book.entries.clear();
+    book.archiveOffset = 0;
+}
+
+bool isBinaryBook(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    char magic[8];
+    bool binary = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                  memcmp(magic, BOOK_MAGIC, sizeof(magic)) == 0;
+    fclose(file);
+    return binary;
+}
+
+bool loadBook(const char *path, BookTree &book)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    BookHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, BOOK_MAGIC, sizeof(header.magic)) != 0)
+    {
+        fclose(file);
+        return false;
+    }
+
+    initBook(book);
+    book.archiveOffset = header.archiveOffset;
+    book.entries.reserve(header.entryCount);
+
+    BookEntry entry;
+    for (uint64_t i = 0; i < header.entryCount; i++)
+    {
+        if (fread(&entry, sizeof(entry), 1, file) != 1)
+        {
+            fclose(file);
+            return false;
+        }
+        book.entries[getBookKey(entry)] = entry;
+    }
+
+    fclose(file);
+    return true;
+}
+
+bool saveBook(const char *path, BookTree const&book)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    BookHeader header;
+    memcpy(header.magic, BOOK_MAGIC, sizeof(header.magic));
+    header.entryCount = book.entries.size();
+    header.archiveOffset = book.archiveOffset;
+
+    // Ordenado por clave para que el mismo libro de siempre el mismo archivo
+    std::vector<uint64_t> keys;
+    keys.reserve(book.entries.size());
+    for (auto const&kv : book.entries)
+        keys.push_back(kv.first);
+    std::sort(keys.begin(), keys.end());
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (size_t i = 0; ok && i < keys.size(); i++)
+        ok = fwrite(&book.entries.at(keys[i]), sizeof(BookEntry), 1, file) == 1;
+
+    return (fclose(file) == 0) && ok;
+}
+
+uint64_t getBookKey(BookEntry const&entry)
+{
+    return hashBitboard(Bitboard{entry.black, entry.white}, (Player)entry.player);
+}
+
+// Agrega una posicion en su orientacion canonica; devuelve true si es nueva
+static bool addBookPosition(BookTree &book, Bitboard const&board, Player player,
+                            Bitboard &canonical)
+{
+    int symmetry;
+    canonical = canonicalBitboard(board, symmetry);
+    uint64_t key = hashBitboard(canonical, player);
+    if (book.entries.count(key))
+        return false;
+
+    BookEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.black = canonical.black;
+    entry.white = canonical.white;
+    entry.player = (uint8_t)player;
+    entry.bestMove = BOOK_NO_MOVE;
+    entry.searchMove = BOOK_NO_MOVE;
+    book.entries[key] = entry;
+    return true;
+}
+
+static Bitboard getStartBitboard(Player &player)
+{
+    tree_logic start;
+    startState(start);
+    player = start.currentPlayer;
+    return getBitboard(start);
+}
+
+int expandBook(BookTree &book, int plies)
+{
+    Player player;
+    Bitboard start = getStartBitboard(player);
+    Bitboard canonical;
+    int added = addBookPosition(book, start, player, canonical) ? 1 : 0;
+
+    // Una capa por vez, sin repetir posiciones simetricas ni transpuestas
+    std::vector<std::pair<Bitboard, Player>> level = {{canonical, player}};
+    std::unordered_set<uint64_t> seen = {hashBitboard(canonical, player)};
+
+    for (int ply = 0; ply < plies; ply++)
+    {
+        std::vector<std::pair<Bitboard, Player>> next;
+
+        for (auto const&position : level)
+        {
+            uint64_t own, opponent;
+            splitBitboard(position.first, position.second, own, opponent);
+
+            for (uint64_t moves = getMovesMask(own, opponent); moves; moves &= moves - 1)
+            {
+                Bitboard child = position.first;
+                Player childPlayer = position.second;
+                playBitboardMove(child, childPlayer, __builtin_ctzll(moves));
+
+                if (addBookPosition(book, child, childPlayer, canonical))
+                    added++;
+                if (seen.insert(hashBitboard(canonical, childPlayer)).second)
+                    next.push_back({canonical, childPlayer});
+            }
+        }
+
+        level.swap(next);
+    }
+
+    return added;
+}
+
+int addBookGame(BookTree &book, const uint8_t *moves, int moveCount, int plies)
+{
+    Player player;
+    Bitboard board = getStartBitboard(player);
+    Bitboard canonical;
+    int added = addBookPosition(book, board, player, canonical) ? 1 : 0;
+
+    for (int i = 0; i < moveCount && i < plies; i++)
+    {
+        if (!playBitboardMove(board, player, moves[i]))
+            break;
+        if (addBookPosition(book, board, player, canonical))
+            added++;
+    }
+
+    return added;
+}
+
+int searchBook(BookTree &book, int depth, BookSearchCallback callback)
+{
+    std::vector<uint64_t> pending;
+    for (auto const&kv : book.entries)
+        if (kv.second.searchDepth < depth)
+            pending.push_back(kv.first);
+    std::sort(pending.begin(), pending.end());
+
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        BookEntry &entry = book.entries[pending[i]];
+        Player player = (Player)entry.player;
+        tree_logic state = getTreeLogic(Bitboard{entry.black, entry.white}, player);
+
+        entry.searchMove = BOOK_NO_MOVE;
+        if (state.gameOver)
+        {
+            // Partida terminada: el valor exacto, en la escala de value_state
+            uint64_t own, opponent;
+            splitBitboard(Bitboard{entry.black, entry.white}, player, own, opponent);
+            entry.searchValue = FINAL_DISC_VALUE *
+                                (__builtin_popcountll(own) - __builtin_popcountll(opponent));
+        }
+        else
+        {
+            SearchResult result = searchPosition(state, player, depth, nullptr);
+            entry.searchMove = packSquare(result.bestMove);
+            entry.searchValue = result.value;
+        }
+        entry.searchDepth = depth;
+
+        if (callback != nullptr)
+            callback((int)i + 1, (int)pending.size());
+    }
+
+    return (int)pending.size();
+}
+
+// Valor minimax de una posicion del libro: la mejor de las jugadas que llevan
+// a otra posicion del libro y de la jugada de la busqueda profunda si esa no
+// esta en el libro. Las posiciones ya resueltas quedan en done.
+static int propagateEntry(BookTree &book, BookEntry &entry, std::unordered_set<uint64_t> &done)
+{
+    uint64_t key = getBookKey(entry);
+    if (done.count(key))
+        return entry.value;
+    done.insert(key);
+
+    Player player = (Player)entry.player;
+    Bitboard board = {entry.black, entry.white};
+    uint64_t own, opponent;
+    splitBitboard(board, player, own, opponent);
+
+    bool found = false;
+    bool searchMoveInBook = false;
+    int bestValue = 0;
+    int bestMove = BOOK_NO_MOVE;
+
+    for (uint64_t moves = getMovesMask(own, opponent); moves; moves &= moves - 1)
+    {
+        int square = __builtin_ctzll(moves);
+        Bitboard child = board;
+        Player childPlayer = player;
+        playBitboardMove(child, childPlayer, square);
+
+        int symmetry;
+        auto it = book.entries.find(hashBitboard(canonicalBitboard(child, symmetry), childPlayer));
+        if (it == book.entries.end())
+            continue;
+
+        int value = propagateEntry(book, it->second, done);
+        if (childPlayer != player)
+            value = -value;
+
+        if (!found || value > bestValue)
+        {
+            bestValue = value;
+            bestMove = square;
+            found = true;
+        }
+        if (square == entry.searchMove)
+            searchMoveInBook = true;
+    }
+
+    // Las jugadas del libro ganan los empates: estan analizadas mas a fondo
+    bool searched = entry.searchDepth > 0 && entry.searchMove != BOOK_NO_MOVE;
+    if (searched && !searchMoveInBook && (!found || entry.searchValue > bestValue))
+    {
+        bestValue = entry.searchValue;
+        bestMove = entry.searchMove;
+        found = true;
+    }
+
+    entry.value = found ? bestValue : entry.searchValue;
+    entry.bestMove = (uint8_t)bestMove;
+    return entry.value;
+}
+
+void propagateBook(BookTree &book)
+{
+    std::unordered_set<uint64_t> done;
+    for (auto &kv : book.entries)
+        propagateEntry(book, kv.second, done);
+}
@@ -0,0 +1,130 @@
+/**
+ * @brief Binary opening book built from deep searches
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "bitboard.h"
+
+#define BOOK_MAGIC "EDABOOK1"
+#define BOOK_NO_MOVE 0xff
+
+// Cabecera del archivo, seguida de una BookEntry por posicion
+struct BookHeader
+{
+    char magic[8];
+    uint64_t entryCount;
+    uint64_t archiveOffset;     // partidas del archivo ya agregadas al libro
+};
+
+// Posicion del libro, guardada en su orientacion canonica (canonicalBitboard).
+// Las jugadas estan en esa misma orientacion y los valores son para el
+// jugador que mueve.
+struct BookEntry
+{
+    uint64_t black;
+    uint64_t white;
+    int32_t value;              // minimax sobre los hijos que estan en el libro
+    int32_t searchValue;        // busqueda profunda de la posicion
+    uint8_t player;
+    uint8_t bestMove;           // y * BOARD_SIZE + x, BOOK_NO_MOVE = ninguna
+    uint8_t searchMove;
+    uint8_t searchDepth;        // 0 = todavia sin buscar
+    uint8_t padding[4];
+};
+
+struct BookTree
+{
+    std::unordered_map<uint64_t, BookEntry> entries;    // por hashBitboard
+    uint64_t archiveOffset;
+};
+
+typedef void (*BookSearchCallback)(int searched, int total);
+
+/**
+ * @brief Empties a book.
+ *
+ * @param book The book.
+ */
+void initBook(BookTree &book);
+
+/**
+ * @brief Checks whether a file is a binary book.
+ *
+ * @param path The file.
+ * @return It starts with BOOK_MAGIC.
+ */
+bool isBinaryBook(const char *path);
+
+/**
+ * @brief Reads a book written by saveBook.
+ *
+ * @param path The file.
+ * @param book The book.
+ * @return File read.
+ */
+bool loadBook(const char *path, BookTree &book);
+
+/**
+ * @brief Writes a book, sorted by key.
+ *
+ * @param path The file.
+ * @param book The book.
+ * @return File written.
+ */
+bool saveBook(const char *path, BookTree const&book);
+
+/**
+ * @brief Key of a book entry, the same as canonicalHash of its position.
+ *
+ * @param entry The entry.
+ * @return The key.
+ */
+uint64_t getBookKey(BookEntry const&entry);
+
+/**
+ * @brief Adds every position up to some plies from the start.
+ *
+ * @param book The book.
+ * @param plies The plies.
+ * @return The amount of new positions.
+ */
+int expandBook(BookTree &book, int plies);
+
+/**
+ * @brief Adds the first positions of a game.
+ *
+ * @param book The book.
+ * @param moves The packed moves (y * BOARD_SIZE + x).
+ * @param moveCount The amount of moves.
+ * @param plies The maximum plies to add.
+ * @return The amount of new positions.
+ */
+int addBookGame(BookTree &book, const uint8_t *moves, int moveCount, int plies);
+
+/**
+ * @brief Searches every position not yet searched to some depth.
+ *
+ * @param book The book.
+ * @param depth The search depth.
+ * @param callback Called after each search, or nullptr.
+ * @return The amount of searched positions.
+ */
+int searchBook(BookTree &book, int depth, BookSearchCallback callback);
+
+/**
+ * @brief Backs up the search values through the book with minimax and
+ *        sets the move to play at every position.
+ *
+ * @param book The book.
+ */
+void propagateBook(BookTree &book);
+
+#endif
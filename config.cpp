@@ -0,0 +1,420 @@
+/**
+ * @brief Runtime configuration of the Reversi game AI
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sys/stat.h>
+
+#include "config.h"
+
+static AIConfig g_config;
+static bool g_configInitialized = false;
+static int g_configVersion = 0;
+static std::string g_configPath;
+static time_t g_configModified = 0;
+
+static const char *STAGE_NAMES[STAGE_COUNT] = {"midgame", "late", "endgame"};
+static const char *DRIVER_NAMES[] = {"plain", "pvs", "aspiration", "mtdf"};
+
+void initConfig(AIConfig &config)
+{
+    config.stages[STAGE_MIDGAME].maxDepth = 5;
+    config.stages[STAGE_MIDGAME].timeShare = 0.05;
+    config.stages[STAGE_LATE].maxDepth = 7;
+    config.stages[STAGE_LATE].timeShare = 0.15;
+    config.stages[STAGE_ENDGAME].maxDepth = 0;
+    config.stages[STAGE_ENDGAME].timeShare = 0.5;
+
+    config.lateEmpties = 14;
+    config.endgameEmpties = 8;
+    config.maxNodes = 50000;
+    config.timeBudget = 0;
+    config.driver = DRIVER_PLAIN;
+    config.aspirationWindow = 40;
+    config.ttSizeMB = 16;
+    config.ttHugePages = true;
+    config.evalCacheKB = 512;
+    config.threads = 1;
+    config.evalWeightsPath.clear();
+    config.nnuePath.clear();
+    config.bookPath.clear();
+    config.archivePath.clear();
+
+    config.weights.pieces = 10;
+    config.weights.mobility = 5;
+    config.weights.corners = 50;
+    config.weights.adjacents = 3;
+    config.weights.stability = 20;
+
+    config.probCut = false;
+    config.probCutThreshold = 1.5;
+    config.probCutPath = "probcut.ini";
+
+    config.endgameCacheMB = 8;
+    config.endgameCachePath.clear();
+    config.endgameCacheMinEmpties = 4;
+    config.endgameCacheMaxEmpties = 12;
+    config.endgameSplitMinEmpties = 12;
+
+    config.serverWorkers = 0;
+    config.serverTTSizeMB = 1;
+    config.serverTimeBudget = 60;
+
+    config.recordPath.clear();
+    config.tracePath.clear();
+    config.liveAnalysis = true;
+    config.liveMaxDepth = 8;
+}
+
+// Saca espacios al principio y al final
+static std::string trim(const std::string &s)
+{
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos)
+        return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+bool parseIniFile(const char *path, std::map<std::string, std::string> &values)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    std::string section;
+    std::string line;
+    int lineNumber = 0;
+    bool ok = true;
+
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        size_t comment = line.find_first_of("#;");
+        if (comment != std::string::npos)
+            line.erase(comment);
+        line = trim(line);
+        if (line.empty())
+            continue;
+
+        if (line[0] == '[')
+        {
+            size_t close = line.find(']');
+            if (close == std::string::npos)
+            {
+                printf("%s:%d: seccion sin cerrar\n", path, lineNumber);
+                ok = false;
+                continue;
+            }
+            section = trim(line.substr(1, close - 1));
+            continue;
+        }
+
+        size_t equal = line.find('=');
+        if (equal == std::string::npos)
+        {
+            printf("%s:%d: se esperaba clave = valor\n", path, lineNumber);
+            ok = false;
+            continue;
+        }
+
+        std::string key = trim(line.substr(0, equal));
+        if (!section.empty())
+            key = section + "." + key;
+        values[key] = trim(line.substr(equal + 1));
+    }
+
+    return ok;
+}
+
+static void readInt(std::map<std::string, std::string> &values, const std::string &key, int &out)
+{
+    auto it = values.find(key);
+    if (it == values.end())
+        return;
+    out = atoi(it->second.c_str());
+    values.erase(it);
+}
+
+static void readDouble(std::map<std::string, std::string> &values, const std::string &key, double &out)
+{
+    auto it = values.find(key);
+    if (it == values.end())
+        return;
+    out = atof(it->second.c_str());
+    values.erase(it);
+}
+
+static void readString(std::map<std::string, std::string> &values, const std::string &key, std::string &out)
+{
+    auto it = values.find(key);
+    if (it == values.end())
+        return;
+    out = it->second;
+    values.erase(it);
+}
+
+static void readWeights(std::map<std::string, std::string> &values, const std::string &prefix, EvalWeights &weights)
+{
+    readInt(values, prefix + "pieces", weights.pieces);
+    readInt(values, prefix + "mobility", weights.mobility);
+    readInt(values, prefix + "corners", weights.corners);
+    readInt(values, prefix + "adjacents", weights.adjacents);
+    readInt(values, prefix + "stability", weights.stability);
+}
+
+static time_t getModifiedTime(const std::string &path)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+        return 0;
+    return info.st_mtime;
+}
+
+bool loadEvalWeights(const char *path, EvalWeights &weights)
+{
+    std::map<std::string, std::string> values;
+    if (!parseIniFile(path, values))
+        return false;
+    readWeights(values, "", weights);
+    return true;
+}
+
+// Lee todas las claves conocidas; las que sobran se informan como error
+static bool readConfigValues(std::map<std::string, std::string> &values, const char *source,
+                             AIConfig &config)
+{
+    bool ok = true;
+
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        std::string prefix = std::string("stage.") + STAGE_NAMES[stage] + ".";
+        readInt(values, prefix + "depth", config.stages[stage].maxDepth);
+        readDouble(values, prefix + "time_share", config.stages[stage].timeShare);
+    }
+    readInt(values, "search.late_empties", config.lateEmpties);
+    readInt(values, "search.endgame_empties", config.endgameEmpties);
+    readInt(values, "search.max_nodes", config.maxNodes);
+    readDouble(values, "search.time_budget", config.timeBudget);
+    readInt(values, "search.aspiration_window", config.aspirationWindow);
+    readInt(values, "search.tt_size_mb", config.ttSizeMB);
+    int ttHugePages = config.ttHugePages;
+    readInt(values, "search.tt_huge_pages", ttHugePages);
+    config.ttHugePages = (ttHugePages != 0);
+    readInt(values, "search.eval_cache_kb", config.evalCacheKB);
+    readInt(values, "search.threads", config.threads);
+    readString(values, "eval.weights_file", config.evalWeightsPath);
+    readString(values, "eval.nnue_file", config.nnuePath);
+    readWeights(values, "eval.", config.weights);
+    readString(values, "book.path", config.bookPath);
+    readString(values, "archive.path", config.archivePath);
+
+    std::string driver = DRIVER_NAMES[config.driver];
+    readString(values, "search.driver", driver);
+    bool knownDriver = false;
+    for (int i = 0; i <= DRIVER_MTDF; i++)
+    {
+        if (driver == DRIVER_NAMES[i])
+        {
+            config.driver = (SearchDriver)i;
+            knownDriver = true;
+        }
+    }
+    if (!knownDriver)
+    {
+        printf("%s: search.driver desconocido '%s'\n", source, driver.c_str());
+        ok = false;
+    }
+
+    int probCut = config.probCut;
+    readInt(values, "probcut.enabled", probCut);
+    config.probCut = (probCut != 0);
+    readDouble(values, "probcut.threshold", config.probCutThreshold);
+    readString(values, "probcut.params_file", config.probCutPath);
+
+    readInt(values, "endgame.cache_mb", config.endgameCacheMB);
+    readString(values, "endgame.cache_file", config.endgameCachePath);
+    readInt(values, "endgame.min_empties", config.endgameCacheMinEmpties);
+    readInt(values, "endgame.max_empties", config.endgameCacheMaxEmpties);
+    readInt(values, "endgame.split_min_empties", config.endgameSplitMinEmpties);
+
+    readInt(values, "server.workers", config.serverWorkers);
+    readInt(values, "server.tt_size_mb", config.serverTTSizeMB);
+    readDouble(values, "server.time_budget", config.serverTimeBudget);
+
+    readString(values, "record.path", config.recordPath);
+
+    readString(values, "trace.path", config.tracePath);
+
+    int liveAnalysis = config.liveAnalysis;
+    readInt(values, "live.enabled", liveAnalysis);
+    config.liveAnalysis = (liveAnalysis != 0);
+    readInt(values, "live.max_depth", config.liveMaxDepth);
+
+    for (auto &kv : values)
+        printf("%s: clave desconocida '%s'\n", source, kv.first.c_str());
+
+    if (!config.evalWeightsPath.empty() &&
+        !loadEvalWeights(config.evalWeightsPath.c_str(), config.weights))
+    {
+        printf("No se pudo leer el archivo de pesos %s\n", config.evalWeightsPath.c_str());
+        ok = false;
+    }
+
+    if (config.threads < 1)
+        config.threads = 1;
+
+    return ok;
+}
+
+static void activateConfig(AIConfig const& config)
+{
+    g_config = config;
+    g_configInitialized = true;
+    g_configVersion++;
+}
+
+bool loadConfig(const char *path)
+{
+    AIConfig config;
+    initConfig(config);
+
+    g_configPath = path;
+    g_configModified = getModifiedTime(g_configPath);
+
+    std::map<std::string, std::string> values;
+    bool ok = true;
+
+    if (g_configModified != 0)
+        ok = parseIniFile(path, values);
+
+    // Sin archivo igual se cargan los pesos de los valores incorporados
+    ok = readConfigValues(values, path, config) && ok;
+
+    activateConfig(config);
+    return ok;
+}
+
+bool setConfigValues(std::map<std::string, std::string> values, const char *source)
+{
+    AIConfig config;
+    initConfig(config);
+
+    // Sin archivo no hay nada que recargar
+    g_configPath.clear();
+    g_configModified = 0;
+
+    bool ok = readConfigValues(values, source, config);
+    activateConfig(config);
+    return ok;
+}
+
+static std::string formatDouble(double value)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%.15g", value);
+    return text;
+}
+
+void getConfigValues(AIConfig const& config, std::map<std::string, std::string> &values)
+{
+    values.clear();
+
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        std::string prefix = std::string("stage.") + STAGE_NAMES[stage] + ".";
+        values[prefix + "depth"] = std::to_string(config.stages[stage].maxDepth);
+        values[prefix + "time_share"] = formatDouble(config.stages[stage].timeShare);
+    }
+    values["search.late_empties"] = std::to_string(config.lateEmpties);
+    values["search.endgame_empties"] = std::to_string(config.endgameEmpties);
+    values["search.max_nodes"] = std::to_string(config.maxNodes);
+    values["search.time_budget"] = formatDouble(config.timeBudget);
+    values["search.aspiration_window"] = std::to_string(config.aspirationWindow);
+    values["search.tt_size_mb"] = std::to_string(config.ttSizeMB);
+    values["search.tt_huge_pages"] = std::to_string((int)config.ttHugePages);
+    values["search.eval_cache_kb"] = std::to_string(config.evalCacheKB);
+    values["search.threads"] = std::to_string(config.threads);
+    values["search.driver"] = DRIVER_NAMES[config.driver];
+
+    // Los pesos ya incluyen los del archivo de pesos
+    values["eval.nnue_file"] = config.nnuePath;
+    values["eval.pieces"] = std::to_string(config.weights.pieces);
+    values["eval.mobility"] = std::to_string(config.weights.mobility);
+    values["eval.corners"] = std::to_string(config.weights.corners);
+    values["eval.adjacents"] = std::to_string(config.weights.adjacents);
+    values["eval.stability"] = std::to_string(config.weights.stability);
+
+    values["book.path"] = config.bookPath;
+    values["archive.path"] = config.archivePath;
+
+    values["probcut.enabled"] = std::to_string((int)config.probCut);
+    values["probcut.threshold"] = formatDouble(config.probCutThreshold);
+    values["probcut.params_file"] = config.probCutPath;
+
+    values["endgame.cache_mb"] = std::to_string(config.endgameCacheMB);
+    values["endgame.cache_file"] = config.endgameCachePath;
+    values["endgame.min_empties"] = std::to_string(config.endgameCacheMinEmpties);
+    values["endgame.max_empties"] = std::to_string(config.endgameCacheMaxEmpties);
+    values["endgame.split_min_empties"] = std::to_string(config.endgameSplitMinEmpties);
+
+    values["server.workers"] = std::to_string(config.serverWorkers);
+    values["server.tt_size_mb"] = std::to_string(config.serverTTSizeMB);
+    values["server.time_budget"] = formatDouble(config.serverTimeBudget);
+
+    values["record.path"] = config.recordPath;
+
+    values["trace.path"] = config.tracePath;
+
+    values["live.enabled"] = std::to_string((int)config.liveAnalysis);
+    values["live.max_depth"] = std::to_string(config.liveMaxDepth);
+}
+
+bool reloadConfigIfChanged()
+{
+    if (g_configPath.empty())
+        return false;
+
+    time_t modified = getModifiedTime(g_configPath);
+    if (modified == g_configModified)
+        return false;
+
+    printf("Recargando configuracion %s\n", g_configPath.c_str());
+    loadConfig(g_configPath.c_str());
+    return true;
+}
+
+AIConfig const& getConfig()
+{
+    if (!g_configInitialized)
+    {
+        initConfig(g_config);
+        g_configInitialized = true;
+    }
+    return g_config;
+}
+
+int getConfigVersion()
+{
+    return g_configVersion;
+}
+
+const char *getStageName(GameStage stage)
+{
+    return STAGE_NAMES[stage];
+}
+
+GameStage getGameStage(AIConfig const& config, int emptySquares)
+{
+    if (emptySquares <= config.endgameEmpties)
+        return STAGE_ENDGAME;
+    if (emptySquares <= config.lateEmpties)
+        return STAGE_LATE;
+    return STAGE_MIDGAME;
+}
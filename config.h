@@ -0,0 +1,174 @@
+/**
+ * @brief Runtime configuration of the Reversi game AI
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <map>
+#include <string>
+
+#define CONFIG_DEFAULT_PATH "edaversi.ini"
+
+enum GameStage
+{
+    STAGE_MIDGAME,
+    STAGE_LATE,
+    STAGE_ENDGAME,
+    STAGE_COUNT,
+};
+
+enum SearchDriver
+{
+    DRIVER_PLAIN,               // una pasada con ventana completa
+    DRIVER_PVS,                 // ventana nula para las jugadas que no son la primera
+    DRIVER_ASPIRATION,          // profundizacion iterativa con ventana de aspiracion + PVS
+    DRIVER_MTDF,                // profundizacion iterativa con MTD(f) sobre la tabla
+};
+
+struct StageConfig
+{
+    int maxDepth;               // 0 = sin limite (fuerza bruta)
+    double timeShare;           // fraccion del tiempo restante por jugada
+};
+
+struct EvalWeights
+{
+    int pieces;
+    int mobility;
+    int corners;
+    int adjacents;
+    int stability;              // por ficha estable de diferencia
+};
+
+struct AIConfig
+{
+    StageConfig stages[STAGE_COUNT];
+    int lateEmpties;            // casillas vacias desde las que empieza STAGE_LATE
+    int endgameEmpties;         // casillas vacias desde las que empieza STAGE_ENDGAME
+    int maxNodes;
+    double timeBudget;          //en segundos por partida, 0 = sin limite
+    SearchDriver driver;
+    int aspirationWindow;
+    int ttSizeMB;
+    bool ttHugePages;           // tabla en paginas de 2 MB si el sistema las da
+    int evalCacheKB;            // evaluaciones de hojas por posicion, 0 = sin cache
+    int threads;                // hilos de busqueda (Lazy SMP), 1 = sin ayudantes
+    std::string evalWeightsPath;
+    std::string nnuePath;       // red de nnue.h, vacio = evaluacion lineal
+    std::string bookPath;
+    std::string archivePath;    // partidas terminadas, vacio = no se guardan
+    EvalWeights weights;
+    bool probCut;
+    double probCutThreshold;    // cuantas sigmas fuera de la ventana para podar
+    std::string probCutPath;
+    int endgameCacheMB;         // 0 = sin cache de finales resueltos
+    std::string endgameCachePath;   // vacio = solo en memoria
+    int endgameCacheMinEmpties;
+    int endgameCacheMaxEmpties;
+    int endgameSplitMinEmpties; // con varios hilos, nodos que se reparten
+    int serverWorkers;          // hilos que buscan en modo servidor, 0 = uno por nucleo
+    int serverTTSizeMB;         // tabla de transposicion de cada partida del servidor
+    double serverTimeBudget;    // segundos por partida de la IA en el servidor, 0 = sin limite
+    std::string recordPath;     // registro de decisiones de getBestMove, vacio = no se graba
+    std::string tracePath;      // linea de tiempo de las busquedas (trace.h), vacio = sin trazas
+    bool liveAnalysis;          // analizar las jugadas del humano mientras piensa
+    int liveMaxDepth;           // profundidad maxima de ese analisis
+};
+
+/**
+ * @brief Reads a simple INI file: "[section]" headers, "key = value" lines
+ *        and comments starting with '#' or ';'.
+ *
+ * @param path The file.
+ * @param values Receives the values, keyed as "section.key".
+ * @return File read without syntax errors.
+ */
+bool parseIniFile(const char *path, std::map<std::string, std::string> &values);
+
+/**
+ * @brief Fills a configuration with the built-in defaults.
+ *
+ * @param config The configuration.
+ */
+void initConfig(AIConfig &config);
+
+/**
+ * @brief Parses a configuration file and makes it the active one.
+ *        A missing file keeps the defaults.
+ *
+ * @param path The INI file.
+ * @return File parsed without errors.
+ */
+bool loadConfig(const char *path);
+
+/**
+ * @brief Makes a configuration given as "section.key" values the active one,
+ *        starting from the defaults. There is no file to reload afterwards.
+ *
+ * @param values The values, as read by parseIniFile.
+ * @param source The name used in error messages.
+ * @return All keys known and valid.
+ */
+bool setConfigValues(std::map<std::string, std::string> values, const char *source);
+
+/**
+ * @brief Writes every setting of a configuration as "section.key" values,
+ *        with the weights file already applied.
+ *
+ * @param config The configuration.
+ * @param values Receives the values.
+ */
+void getConfigValues(AIConfig const& config, std::map<std::string, std::string> &values);
+
+/**
+ * @brief Parses the active configuration file again if it changed on disk.
+ *
+ * @return The configuration was reloaded.
+ */
+bool reloadConfigIfChanged();
+
+/**
+ * @brief Returns the active configuration.
+ *
+ * @return The configuration.
+ */
+AIConfig const& getConfig();
+
+/**
+ * @brief Returns a counter that increases every time the configuration is loaded.
+ *
+ * @return The version.
+ */
+int getConfigVersion();
+
+/**
+ * @brief Returns the game stage for an amount of empty squares.
+ *
+ * @param config The configuration.
+ * @param emptySquares Empty squares on the board.
+ * @return The game stage.
+ */
+GameStage getGameStage(AIConfig const& config, int emptySquares);
+
+/**
+ * @brief Returns the name of a game stage as used in configuration files.
+ *
+ * @param stage The game stage.
+ * @return The name.
+ */
+const char *getStageName(GameStage stage);
+
+/**
+ * @brief Reads evaluation weights from a "key = value" file.
+ *
+ * @param path The file.
+ * @param weights The weights to update.
+ * @return File read.
+ */
+bool loadEvalWeights(const char *path, EvalWeights &weights);
+
+#endif
@@ -6,17 +6,86 @@
  */
 
 #include <algorithm>
+#include <cstdio>
 
 #include "raylib.h"
 
 #include "ai.h"
+#include "config.h"
+#include "gamedb.h"
+#include "liveanalysis.h"
 #include "view.h"
 #include "controller.h"
 
+// Analisis de las jugadas del humano mientras piensa
+static LiveAnalysis g_liveAnalysis;
+
+/**
+ * @brief Saves the game to the archive once it is over.
+ *
+ * @param model The game model.
+ */
+static void archiveIfGameOver(GameModel &model)
+{
+    std::string const&path = getConfig().archivePath;
+
+    if (model.tree.gameOver && !path.empty() && !archiveGame(path.c_str(), model))
+        printf("No se pudo guardar la partida en %s\n", path.c_str());
+}
+
+/**
+ * @brief Moves through the game with the keyboard: left or Ctrl+Z back,
+ *        right or Ctrl+Y forward, Home and End to the ends. Going back
+ *        stops on the human player's turn, never before the first one,
+ *        or the AI would play again.
+ *
+ * @param model The game model.
+ */
+static void navigateGame(GameModel &model)
+{
+    bool control = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+    bool back = IsKeyPressed(KEY_LEFT) || (control && IsKeyPressed(KEY_Z));
+    bool forward = IsKeyPressed(KEY_RIGHT) || (control && IsKeyPressed(KEY_Y));
+    bool start = IsKeyPressed(KEY_HOME);
+    bool end = IsKeyPressed(KEY_END);
+
+    if (!back && !forward && !start && !end)
+        return;
+    stopLiveAnalysis(g_liveAnalysis);
+
+    if (back)
+    {
+        while (undoModel(model) && (model.tree.currentPlayer != model.humanPlayer))
+            ;
+        // Antes del primer turno del humano mueve la IA: se vuelve a ese turno
+        while ((model.tree.currentPlayer != model.humanPlayer) && redoModel(model))
+            ;
+    }
+    else if (forward)
+    {
+        while (redoModel(model) && !model.tree.gameOver &&
+               (model.tree.currentPlayer != model.humanPlayer))
+            ;
+    }
+    else if (start)
+    {
+        goToModelMove(model, 0);
+        while ((model.tree.currentPlayer != model.humanPlayer) && redoModel(model))
+            ;
+    }
+    else
+        goToModelMove(model, getModelMoveCount(model));
+}
+
 bool updateView(GameModel &model)
 {
     if (WindowShouldClose())
+    {
+        stopLiveAnalysis(g_liveAnalysis);
         return false;
+    }
+
+    navigateGame(model);
 
     if (model.tree.gameOver)
     {
@@ -41,6 +110,12 @@ bool updateView(GameModel &model)
         if(model.first_human_try){      //clausula para que no llame a la funcion getValidMoves innecesariamente
             getValidMoves(model, model.human_moves);
             model.first_human_try = false;
+
+            // La configuracion se recarga aca, con el analisis parado: el
+            // hilo del analisis solo la lee
+            prepareSearch();
+            if (getConfig().liveAnalysis)
+                startLiveAnalysis(g_liveAnalysis, model, getConfig().liveMaxDepth);
         }
         if (IsMouseButtonPressed(0))
         {
@@ -53,7 +128,9 @@ bool updateView(GameModel &model)
                 {
                     if ((square.x == move.x) &&
                         (square.y == move.y)){
+                        stopLiveAnalysis(g_liveAnalysis);
                         playMove(model, square);
+                        archiveIfGameOver(model);
                     }
                 }
             }
@@ -62,9 +139,11 @@ bool updateView(GameModel &model)
     else
     {
         // AI player
+        stopLiveAnalysis(g_liveAnalysis);
         Square square = getBestMove(model);
 
         playMove(model, square);
+        archiveIfGameOver(model);
     }
 
     if ((IsKeyDown(KEY_LEFT_ALT) ||
@@ -72,6 +151,6 @@ bool updateView(GameModel &model)
         IsKeyPressed(KEY_ENTER))
         ToggleFullscreen();
 
-    drawView(model, model.human_moves);
+    drawView(model, model.human_moves, &readLiveAnalysis(g_liveAnalysis));
     return true;
 }
@@ -0,0 +1,215 @@
+/**
+ * @brief Persistent cache of solved endgame positions
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "endgame.h"
+
+static_assert(sizeof(EndgameEntry) == 16, "Cuatro entradas por linea de cache");
+
+// Mapea el archivo de la cache, creandolo o empezandolo de nuevo si no tiene
+// el tamaño esperado
+static bool mapEndgameFile(EndgameCache &cache, const char *path, size_t bucketCount)
+{
+    size_t size = sizeof(EndgameCacheHeader) +
+                  bucketCount * ENDGAME_BUCKET_SIZE * sizeof(EndgameEntry);
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    bool fresh = fstat(fd, &info) != 0 || (size_t)info.st_size != size;
+    if (fresh && ftruncate(fd, 0) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    if (fresh && ftruncate(fd, size) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    EndgameCacheHeader *header = (EndgameCacheHeader *)data;
+    if (memcmp(header->magic, ENDGAME_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->bucketCount != bucketCount)
+    {
+        memset(data, 0, size);
+        memcpy(header->magic, ENDGAME_CACHE_MAGIC, sizeof(header->magic));
+        header->bucketCount = bucketCount;
+    }
+
+    // Los accesos caen en cualquier lugar del archivo
+    madvise(data, size, MADV_RANDOM);
+
+    cache.mapping = data;
+    cache.mappingSize = size;
+    cache.entries = (EndgameEntry *)((uint8_t *)data + sizeof(EndgameCacheHeader));
+    return true;
+}
+
+bool openEndgameCache(EndgameCache &cache, int sizeMB, const char *path)
+{
+    cache.entries = nullptr;
+    cache.bucketCount = 0;
+    cache.hands.clear();
+    cache.mapping = nullptr;
+    cache.mappingSize = 0;
+    cache.memory.clear();
+    cache.probes = 0;
+    cache.hits = 0;
+
+    if (sizeMB <= 0)
+        return true;
+
+    size_t bucketBytes = ENDGAME_BUCKET_SIZE * sizeof(EndgameEntry);
+    size_t wanted = ((size_t)sizeMB << 20) / bucketBytes;
+    size_t bucketCount = 1;
+    while (bucketCount * 2 <= wanted)
+        bucketCount *= 2;
+
+    cache.bucketCount = bucketCount;
+    cache.hands.assign(bucketCount, 0);
+
+    bool ok = true;
+    if (path != nullptr && path[0] != '\0')
+    {
+        if (mapEndgameFile(cache, path, bucketCount))
+            return true;
+
+        printf("No se pudo mapear %s, la cache de finales queda en memoria\n", path);
+        ok = false;
+    }
+
+    EndgameEntry empty;
+    memset(&empty, 0, sizeof(empty));
+    cache.memory.assign(bucketCount * ENDGAME_BUCKET_SIZE, empty);
+    cache.entries = cache.memory.data();
+    return ok;
+}
+
+void closeEndgameCache(EndgameCache &cache)
+{
+    if (cache.mapping != nullptr)
+        munmap(cache.mapping, cache.mappingSize);
+
+    cache.entries = nullptr;
+    cache.bucketCount = 0;
+    cache.hands.clear();
+    cache.mapping = nullptr;
+    cache.mappingSize = 0;
+    cache.memory.clear();
+}
+
+bool isEndgameCacheOpen(EndgameCache const&cache)
+{
+    return cache.entries != nullptr;
+}
+
+void shareEndgameCache(EndgameCache &cache)
+{
+    if (!cache.locks)
+        cache.locks.reset(new std::mutex[ENDGAME_LOCK_COUNT]);
+}
+
+static EndgameEntry *getBucket(EndgameCache &cache, uint64_t key, size_t &bucket)
+{
+    bucket = key & (cache.bucketCount - 1);
+    return cache.entries + bucket * ENDGAME_BUCKET_SIZE;
+}
+
+// Traba el bucket si la cache es compartida
+static std::unique_lock<std::mutex> lockBucket(EndgameCache &cache, size_t bucket)
+{
+    if (!cache.locks)
+        return std::unique_lock<std::mutex>();
+    return std::unique_lock<std::mutex>(cache.locks[bucket % ENDGAME_LOCK_COUNT]);
+}
+
+bool probeEndgameCache(EndgameCache &cache, uint64_t key, int &lower, int &upper)
+{
+    if (cache.entries == nullptr || key == 0)
+        return false;
+
+    cache.probes++;
+
+    size_t bucket;
+    EndgameEntry *entries = getBucket(cache, key, bucket);
+    std::unique_lock<std::mutex> lock = lockBucket(cache, bucket);
+    for (int i = 0; i < ENDGAME_BUCKET_SIZE; i++)
+    {
+        if (entries[i].key == key)
+        {
+            entries[i].referenced = 1;
+            lower = entries[i].lower;
+            upper = entries[i].upper;
+            cache.hits++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void storeEndgameCache(EndgameCache &cache, uint64_t key, int empties, int lower, int upper)
+{
+    if (cache.entries == nullptr || key == 0)
+        return;
+
+    size_t bucket;
+    EndgameEntry *entries = getBucket(cache, key, bucket);
+    std::unique_lock<std::mutex> lock = lockBucket(cache, bucket);
+    EndgameEntry *target = nullptr;
+
+    for (int i = 0; i < ENDGAME_BUCKET_SIZE && target == nullptr; i++)
+    {
+        if (entries[i].key == key)
+        {
+            // Dos busquedas de la misma posicion acotan el mismo resultado
+            lower = std::max(lower, (int)entries[i].lower);
+            upper = std::min(upper, (int)entries[i].upper);
+            target = &entries[i];
+        }
+    }
+    for (int i = 0; i < ENDGAME_BUCKET_SIZE && target == nullptr; i++)
+    {
+        if (entries[i].key == 0)
+            target = &entries[i];
+    }
+
+    // Reloj: la aguja saltea las entradas usadas desde la ultima vuelta,
+    // sacandoles la marca, y reemplaza la primera que no se uso
+    while (target == nullptr)
+    {
+        uint8_t &hand = cache.hands[bucket];
+        EndgameEntry &candidate = entries[hand];
+        hand = (hand + 1) % ENDGAME_BUCKET_SIZE;
+
+        if (candidate.referenced)
+            candidate.referenced = 0;
+        else
+            target = &candidate;
+    }
+
+    target->key = key;
+    target->lower = (int8_t)lower;
+    target->upper = (int8_t)upper;
+    target->empties = (uint8_t)empties;
+    target->referenced = 1;
+}
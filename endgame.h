@@ -0,0 +1,113 @@
+/**
+ * @brief Persistent cache of solved endgame positions
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef ENDGAME_H
+#define ENDGAME_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define ENDGAME_CACHE_MAGIC "EDAEND01"
+#define ENDGAME_BUCKET_SIZE 4
+#define ENDGAME_LOCK_COUNT 256
+
+// Cotas del resultado final (fichas del jugador que mueve menos las del
+// rival) con juego perfecto. lower == upper si el resultado es exacto.
+struct EndgameEntry
+{
+    uint64_t key;               // canonicalHash, 0 = libre
+    int8_t lower;
+    int8_t upper;
+    uint8_t empties;
+    uint8_t referenced;         // bit del reloj: se uso desde la ultima pasada
+    uint8_t padding[4];
+};
+
+// Cabecera del archivo, seguida de los buckets
+struct EndgameCacheHeader
+{
+    char magic[8];
+    uint64_t bucketCount;
+};
+
+struct EndgameCache
+{
+    EndgameEntry *entries;      // bucketCount * ENDGAME_BUCKET_SIZE
+    size_t bucketCount;
+    std::vector<uint8_t> hands; // aguja del reloj de cada bucket
+    void *mapping;              // archivo mapeado, nullptr si esta en memoria
+    size_t mappingSize;
+    std::vector<EndgameEntry> memory;
+    std::unique_ptr<std::mutex[]> locks;    // por grupos de buckets, nullptr = un solo hilo
+    std::atomic<uint64_t> probes;
+    std::atomic<uint64_t> hits;
+};
+
+/**
+ * @brief Opens a cache, mapping its file if there is one. A file of another
+ *        size is started again.
+ *
+ * @param cache The cache.
+ * @param sizeMB Size in megabytes, rounded down to a power of two buckets.
+ *               0 leaves the cache disabled.
+ * @param path The file, or an empty string to keep it only in memory.
+ * @return Opened. If the file cannot be mapped the cache stays in memory.
+ */
+bool openEndgameCache(EndgameCache &cache, int sizeMB, const char *path);
+
+/**
+ * @brief Closes a cache, leaving its file up to date.
+ *
+ * @param cache The cache.
+ */
+void closeEndgameCache(EndgameCache &cache);
+
+/**
+ * @brief Makes a cache safe to probe and store from several threads, locking
+ *        each bucket. It stays shared when opened again.
+ *
+ * @param cache The cache.
+ */
+void shareEndgameCache(EndgameCache &cache);
+
+/**
+ * @brief Checks whether a cache holds entries.
+ *
+ * @param cache The cache.
+ * @return It is open.
+ */
+bool isEndgameCacheOpen(EndgameCache const&cache);
+
+/**
+ * @brief Looks up a position.
+ *
+ * @param cache The cache.
+ * @param key The canonical hash of the position.
+ * @param lower Receives the lower bound of the result.
+ * @param upper Receives the upper bound of the result.
+ * @return Found.
+ */
+bool probeEndgameCache(EndgameCache &cache, uint64_t key, int &lower, int &upper);
+
+/**
+ * @brief Stores bounds of a result, joining them with the ones already
+ *        stored. When the bucket is full, the clock policy picks the entry
+ *        to replace.
+ *
+ * @param cache The cache.
+ * @param key The canonical hash of the position.
+ * @param empties The empty squares of the position.
+ * @param lower The lower bound of the result.
+ * @param upper The upper bound of the result.
+ */
+void storeEndgameCache(EndgameCache &cache, uint64_t key, int empties, int lower, int upper);
+
+#endif
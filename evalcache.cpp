@@ -0,0 +1,65 @@
+/**
+ * @brief Cache of static evaluations keyed by position
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include "evalcache.h"
+
+#define EVAL_CACHE_FULL (1ULL << 32)
+
+void initEvalCache(EvalCache &cache, int sizeKB)
+{
+    size_t count = 0;
+
+    if (sizeKB > 0)
+    {
+        size_t wanted = ((size_t)sizeKB << 10) / sizeof(EvalCacheSlot);
+        count = 1;
+        while (count * 2 <= wanted)
+            count *= 2;
+    }
+
+    cache.slots.reset(count ? new EvalCacheSlot[count] : nullptr);
+    cache.size = count;
+    cache.mask = count ? count - 1 : 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        cache.slots[i].check.store(0, std::memory_order_relaxed);
+        cache.slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool isEvalCacheEnabled(EvalCache const&cache)
+{
+    return cache.size > 0;
+}
+
+bool probeEvalCache(EvalCache const&cache, uint64_t key, int &value)
+{
+    if (cache.size == 0)
+        return false;
+
+    EvalCacheSlot const&slot = cache.slots[key & cache.mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+    if ((check ^ data) != key || !(data & EVAL_CACHE_FULL))
+        return false;
+    value = (int32_t)(uint32_t)data;
+    return true;
+}
+
+void storeEvalCache(EvalCache &cache, uint64_t key, int value)
+{
+    if (cache.size == 0)
+        return;
+
+    EvalCacheSlot &slot = cache.slots[key & cache.mask];
+    uint64_t data = (uint64_t)(uint32_t)value | EVAL_CACHE_FULL;
+
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
@@ -0,0 +1,69 @@
+/**
+ * @brief Cache of static evaluations keyed by position
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Una entrada por indice, sin buckets: la nueva siempre reemplaza a la vieja.
+// Como en la tabla de transposicion, check = clave ^ data y una entrada que
+// dos hilos escribieron a la vez simplemente no coincide.
+struct EvalCacheSlot
+{
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;     // valor en los 32 bits bajos, bit 32 = ocupada
+};
+
+struct EvalCache
+{
+    std::unique_ptr<EvalCacheSlot[]> slots;
+    size_t size;
+    uint64_t mask;
+};
+
+/**
+ * @brief Allocates an empty cache. Several threads can probe and store at
+ *        the same time without locks.
+ *
+ * @param cache The cache.
+ * @param sizeKB Size in kilobytes, rounded down to a power of two entries.
+ *               0 leaves the cache disabled.
+ */
+void initEvalCache(EvalCache &cache, int sizeKB);
+
+/**
+ * @brief Checks whether a cache holds entries.
+ *
+ * @param cache The cache.
+ * @return It has entries.
+ */
+bool isEvalCacheEnabled(EvalCache const &cache);
+
+/**
+ * @brief Looks up the evaluation of a position.
+ *
+ * @param cache The cache.
+ * @param key The position key.
+ * @param value Receives the evaluation.
+ * @return Found.
+ */
+bool probeEvalCache(EvalCache const &cache, uint64_t key, int &value);
+
+/**
+ * @brief Stores the evaluation of a position.
+ *
+ * @param cache The cache.
+ * @param key The position key.
+ * @param value The evaluation.
+ */
+void storeEvalCache(EvalCache &cache, uint64_t key, int value);
+
+#endif
@@ -0,0 +1,212 @@
+/**
+ * @brief Append-only, memory-mapped archive of finished games
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bitboard.h"
+#include "gamedb.h"
+
+// Mapea un archivo entero en solo lectura. Un archivo vacio o inexistente
+// queda como nullptr con tamaño 0.
+static const uint8_t *mapFile(const std::string &path, size_t &size)
+{
+    size = 0;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+
+    // Se recorre de principio a fin
+    madvise(data, info.st_size, MADV_SEQUENTIAL);
+    size = info.st_size;
+    return (const uint8_t *)data;
+}
+
+bool openGameDatabase(GameDatabase &db, const char *path)
+{
+    db.data = mapFile(path, db.dataSize);
+    db.index = (const GameIndexEntry *)mapFile(std::string(path) + GAMEDB_INDEX_SUFFIX,
+                                               db.indexSize);
+    db.indexCount = db.indexSize / sizeof(GameIndexEntry);
+
+    // Si el archivo existe y tiene datos pero no se pudo mapear, es un error
+    struct stat info;
+    bool exists = (stat(path, &info) == 0);
+    return db.data != nullptr || !exists || info.st_size == 0;
+}
+
+void closeGameDatabase(GameDatabase &db)
+{
+    if (db.data)
+        munmap((void *)db.data, db.dataSize);
+    if (db.index)
+        munmap((void *)db.index, db.indexSize);
+
+    db.data = nullptr;
+    db.dataSize = 0;
+    db.index = nullptr;
+    db.indexSize = 0;
+    db.indexCount = 0;
+}
+
+bool getGame(GameDatabase const&db, uint64_t offset, GameView &game)
+{
+    if (offset + sizeof(GameRecordHeader) > db.dataSize)
+        return false;
+
+    const GameRecordHeader *header = (const GameRecordHeader *)(db.data + offset);
+    if (offset + sizeof(GameRecordHeader) + header->moveCount > db.dataSize)
+        return false;
+
+    game.offset = offset;
+    game.moveCount = header->moveCount;
+    game.discDiff = header->discDiff;
+    game.moves = db.data + offset + sizeof(GameRecordHeader);
+    return true;
+}
+
+bool nextGame(GameDatabase const&db, uint64_t &cursor, GameView &game)
+{
+    if (!getGame(db, cursor, game))
+        return false;
+
+    cursor += sizeof(GameRecordHeader) + game.moveCount;
+    return true;
+}
+
+GameResult getGameResult(int discDiff)
+{
+    if (discDiff > 0)
+        return RESULT_BLACK_WIN;
+    if (discDiff < 0)
+        return RESULT_WHITE_WIN;
+    return RESULT_DRAW;
+}
+
+void findGames(GameDatabase const&db, uint64_t openingKey, GameResult result,
+               std::vector<uint64_t> &offsets)
+{
+    for (size_t i = 0; i < db.indexCount; i++)
+    {
+        GameIndexEntry const&entry = db.index[i];
+
+        if (openingKey != 0 && entry.openingKey != openingKey)
+            continue;
+        if (result != RESULT_ANY && getGameResult(entry.discDiff) != result)
+            continue;
+
+        offsets.push_back(entry.offset);
+    }
+}
+
+bool openGameDatabaseWriter(GameDatabaseWriter &writer, const char *path)
+{
+    writer.data = fopen(path, "ab");
+    writer.index = fopen((std::string(path) + GAMEDB_INDEX_SUFFIX).c_str(), "ab");
+
+    if (!writer.data || !writer.index)
+    {
+        closeGameDatabaseWriter(writer);
+        return false;
+    }
+
+    fseek(writer.data, 0, SEEK_END);
+    writer.offset = ftell(writer.data);
+    return true;
+}
+
+void closeGameDatabaseWriter(GameDatabaseWriter &writer)
+{
+    if (writer.data)
+        fclose(writer.data);
+    if (writer.index)
+        fclose(writer.index);
+
+    writer.data = nullptr;
+    writer.index = nullptr;
+}
+
+bool appendGame(GameDatabaseWriter &writer, const uint8_t *moves, int moveCount, int discDiff)
+{
+    if (moveCount < 0 || moveCount > BOARD_SIZE * BOARD_SIZE)
+        return false;
+
+    GameRecordHeader header;
+    header.moveCount = (uint8_t)moveCount;
+    header.discDiff = (int8_t)discDiff;
+
+    GameIndexEntry entry = {};
+    entry.openingKey = getOpeningKey(moves, moveCount);
+    entry.offset = writer.offset;
+    entry.discDiff = header.discDiff;
+
+    if (fwrite(&header, sizeof(header), 1, writer.data) != 1 ||
+        fwrite(moves, 1, moveCount, writer.data) != (size_t)moveCount ||
+        fwrite(&entry, sizeof(entry), 1, writer.index) != 1)
+        return false;
+
+    writer.offset += sizeof(header) + moveCount;
+    return true;
+}
+
+bool archiveGame(const char *path, GameModel &model)
+{
+    GameDatabaseWriter writer;
+    if (!openGameDatabaseWriter(writer, path))
+        return false;
+
+    std::vector<uint8_t> moves;
+    moves.reserve(model.moveHistory.size());
+    for (auto move : model.moveHistory)
+        moves.push_back(packSquare(move));
+
+    int discDiff = getScore(model, PLAYER_BLACK) - getScore(model, PLAYER_WHITE);
+    bool ok = appendGame(writer, moves.data(), (int)moves.size(), discDiff);
+
+    closeGameDatabaseWriter(writer);
+    return ok;
+}
+
+uint64_t getOpeningKey(const uint8_t *moves, int moveCount)
+{
+    tree_logic start;
+    startState(start);
+    Bitboard board = getBitboard(start);
+    Player player = start.currentPlayer;
+
+    int plies = (moveCount < GAMEDB_OPENING_PLIES) ? moveCount : GAMEDB_OPENING_PLIES;
+    for (int i = 0; i < plies; i++)
+        playBitboardMove(board, player, moves[i]);
+
+    return canonicalHash(board, player);
+}
+
+uint8_t packSquare(Square square)
+{
+    return (uint8_t)(square.y * BOARD_SIZE + square.x);
+}
+
+Square unpackSquare(uint8_t packed)
+{
+    return Square{packed % BOARD_SIZE, packed / BOARD_SIZE};
+}
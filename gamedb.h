@@ -0,0 +1,191 @@
+/**
+ * @brief Append-only, memory-mapped archive of finished games
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef GAMEDB_H
+#define GAMEDB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "model.h"
+
+// Jugadas de la apertura que identifican a una partida en el indice
+#define GAMEDB_OPENING_PLIES 6
+
+#define GAMEDB_INDEX_SUFFIX ".idx"
+
+enum GameResult
+{
+    RESULT_ANY,
+    RESULT_BLACK_WIN,
+    RESULT_WHITE_WIN,
+    RESULT_DRAW,
+};
+
+// Registro en el archivo de datos: moveCount, discDiff y despues una jugada
+// por byte (y * BOARD_SIZE + x). Las pasadas no se guardan.
+struct GameRecordHeader
+{
+    uint8_t moveCount;
+    int8_t discDiff;            // fichas negras - fichas blancas al final
+};
+
+// Entrada del indice (archivo <path>.idx), una por partida
+struct GameIndexEntry
+{
+    uint64_t openingKey;
+    uint64_t offset;            // posicion del registro en el archivo de datos
+    int8_t discDiff;
+    uint8_t padding[7];
+};
+
+// Partida vista directamente sobre el archivo mapeado, sin copiar
+struct GameView
+{
+    uint64_t offset;
+    int moveCount;
+    int discDiff;
+    const uint8_t *moves;
+};
+
+struct GameDatabase
+{
+    const uint8_t *data;
+    size_t dataSize;
+    const GameIndexEntry *index;
+    size_t indexCount;
+    size_t indexSize;
+};
+
+struct GameDatabaseWriter
+{
+    FILE *data;
+    FILE *index;
+    uint64_t offset;
+};
+
+/**
+ * @brief Maps an archive and its index into memory, read-only.
+ *        Games appended later are seen after opening it again.
+ *
+ * @param db The database.
+ * @param path The data file.
+ * @return Opened. A missing file opens as an empty archive.
+ */
+bool openGameDatabase(GameDatabase &db, const char *path);
+
+/**
+ * @brief Unmaps an archive.
+ *
+ * @param db The database.
+ */
+void closeGameDatabase(GameDatabase &db);
+
+/**
+ * @brief Iterates the archive in file order.
+ *
+ * @param db The database.
+ * @param cursor Offset of the next record, start with 0.
+ * @param game Receives the game.
+ * @return There was a game.
+ */
+bool nextGame(GameDatabase const&db, uint64_t &cursor, GameView &game);
+
+/**
+ * @brief Reads the game stored at an offset.
+ *
+ * @param db The database.
+ * @param offset The offset, as stored in the index.
+ * @param game Receives the game.
+ * @return The offset is valid.
+ */
+bool getGame(GameDatabase const&db, uint64_t offset, GameView &game);
+
+/**
+ * @brief Finds games through the index.
+ *
+ * @param db The database.
+ * @param openingKey An opening key, or 0 for any opening.
+ * @param result The result to match.
+ * @param offsets Receives the offsets of the games.
+ */
+void findGames(GameDatabase const&db, uint64_t openingKey, GameResult result,
+               std::vector<uint64_t> &offsets);
+
+/**
+ * @brief Opens an archive for appending, creating it if needed.
+ *
+ * @param writer The writer.
+ * @param path The data file.
+ * @return Opened.
+ */
+bool openGameDatabaseWriter(GameDatabaseWriter &writer, const char *path);
+
+/**
+ * @brief Closes a writer.
+ *
+ * @param writer The writer.
+ */
+void closeGameDatabaseWriter(GameDatabaseWriter &writer);
+
+/**
+ * @brief Appends a game.
+ *
+ * @param writer The writer.
+ * @param moves The packed moves (y * BOARD_SIZE + x).
+ * @param moveCount The amount of moves.
+ * @param discDiff Black discs minus white discs at the end.
+ * @return Written.
+ */
+bool appendGame(GameDatabaseWriter &writer, const uint8_t *moves, int moveCount, int discDiff);
+
+/**
+ * @brief Appends a finished game to an archive.
+ *
+ * @param path The data file.
+ * @param model The game model.
+ * @return Written.
+ */
+bool archiveGame(const char *path, GameModel &model);
+
+/**
+ * @brief Key of the opening of a game: the canonical hash of the position
+ *        after GAMEDB_OPENING_PLIES moves, so symmetric openings share it.
+ *
+ * @param moves The packed moves.
+ * @param moveCount The amount of moves.
+ * @return The key.
+ */
+uint64_t getOpeningKey(const uint8_t *moves, int moveCount);
+
+/**
+ * @brief Classifies a final disc difference.
+ *
+ * @param discDiff Black discs minus white discs.
+ * @return RESULT_BLACK_WIN, RESULT_WHITE_WIN or RESULT_DRAW.
+ */
+GameResult getGameResult(int discDiff);
+
+/**
+ * @brief Packs a square into one byte.
+ *
+ * @param square The square.
+ * @return y * BOARD_SIZE + x.
+ */
+uint8_t packSquare(Square square);
+
+/**
+ * @brief Unpacks a square.
+ *
+ * @param packed y * BOARD_SIZE + x.
+ * @return The square.
+ */
+Square unpackSquare(uint8_t packed);
+
+#endif
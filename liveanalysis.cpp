@@ -0,0 +1,93 @@
+/**
+ * @brief Background analysis of the human player's moves
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include "ai.h"
+#include "liveanalysis.h"
+
+#define LIVE_INDEX 3
+#define LIVE_FRESH 4
+
+static void publishLiveAnalysis(LiveAnalysis &analysis, LiveAnalysisSnapshot const&snapshot)
+{
+    analysis.buffers[analysis.back] = snapshot;
+    analysis.back = analysis.middle.exchange(analysis.back | LIVE_FRESH, std::memory_order_acq_rel) & LIVE_INDEX;
+}
+
+LiveAnalysisSnapshot const&readLiveAnalysis(LiveAnalysis &analysis)
+{
+    if (analysis.middle.load(std::memory_order_relaxed) & LIVE_FRESH)
+        analysis.front = analysis.middle.exchange(analysis.front, std::memory_order_acq_rel) & LIVE_INDEX;
+    return analysis.buffers[analysis.front];
+}
+
+static void runLiveAnalysis(LiveAnalysis *analysis, tree_logic state, Player human,
+                            int version, int maxDepth)
+{
+    Player ia_player = (human == PLAYER_WHITE) ? PLAYER_BLACK : PLAYER_WHITE;
+
+    Moves moves;
+    getValidMoves(state, moves);
+
+    LiveAnalysisSnapshot snapshot;
+    snapshot.version = version;
+    snapshot.sequence = 0;
+    snapshot.count = (int)moves.size();
+    for (int i = 0; i < snapshot.count; i++)
+        snapshot.moves[i] = LiveMoveScore{moves[i], 0, -1};
+    publishLiveAnalysis(*analysis, snapshot);
+
+    int empties = BOARD_SIZE * BOARD_SIZE - (getScore(state, PLAYER_BLACK) + getScore(state, PLAYER_WHITE));
+    for (int depth = 1; depth <= maxDepth; depth++)
+    {
+        // Cerca del final se resuelve de una vez
+        bool solve = (depth >= empties);
+
+        for (int i = 0; i < snapshot.count; i++)
+        {
+            SearchResult result = searchMove(state, ia_player, moves[i], solve ? 0 : depth,
+                                             -SEARCH_INFINITY, SEARCH_INFINITY, &analysis->stop);
+            if (result.outOfTime)
+                return;
+
+            snapshot.moves[i].value = -result.value;
+            snapshot.moves[i].depth = solve ? 0 : depth;
+            snapshot.sequence++;
+            publishLiveAnalysis(*analysis, snapshot);
+        }
+
+        if (solve)
+            break;
+    }
+}
+
+void startLiveAnalysis(LiveAnalysis &analysis, GameModel const&model, int maxDepth)
+{
+    stopLiveAnalysis(analysis);
+
+    for (auto &buffer : analysis.buffers)
+    {
+        buffer.version = -1;
+        buffer.sequence = 0;
+        buffer.count = 0;
+    }
+    analysis.front = 0;
+    analysis.middle = 1;
+    analysis.back = 2;
+    analysis.stop = false;
+
+    analysis.thread = std::thread(runLiveAnalysis, &analysis, model.tree, model.humanPlayer,
+                                  model.version, maxDepth);
+}
+
+void stopLiveAnalysis(LiveAnalysis &analysis)
+{
+    if (!analysis.thread.joinable())
+        return;
+
+    analysis.stop = true;
+    analysis.thread.join();
+}
@@ -0,0 +1,73 @@
+/**
+ * @brief Background analysis of the human player's moves
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef LIVEANALYSIS_H
+#define LIVEANALYSIS_H
+
+#include <atomic>
+#include <thread>
+
+#include "model.h"
+
+// Valor de una jugada del humano a la profundidad mas honda terminada
+struct LiveMoveScore
+{
+    Square move;
+    int value;                  // para el humano: mas es mejor para el
+    int depth;                  // 0 = hasta el final, -1 = todavia sin buscar
+};
+
+struct LiveAnalysisSnapshot
+{
+    int version;                // GameModel::version analizada, -1 = ninguna
+    int sequence;               // cambia con cada jugada buscada
+    int count;
+    LiveMoveScore moves[BOARD_SIZE * BOARD_SIZE];
+};
+
+// Triple buffer: el hilo de analisis escribe en back y lo intercambia con
+// middle; la vista toma middle cuando tiene la marca de nuevo. Ninguno de
+// los dos espera al otro.
+struct LiveAnalysis
+{
+    std::thread thread;
+    std::atomic<bool> stop;
+    LiveAnalysisSnapshot buffers[3];
+    std::atomic<int> middle;    // indice y marca de nuevo
+    int back;                   // del hilo de analisis
+    int front;                  // de la vista
+};
+
+/**
+ * @brief Starts analyzing the moves of the player to move in a thread,
+ *        deepening one ply at a time. The searches maximize the value for
+ *        the AI and go through the shared transposition table, so they also
+ *        prepare the AI's answer to whatever move the human plays.
+ *
+ * @param analysis The analysis. A running one is stopped first.
+ * @param model The game model, on the human player's turn.
+ * @param maxDepth The last depth analyzed.
+ */
+void startLiveAnalysis(LiveAnalysis &analysis, GameModel const &model, int maxDepth);
+
+/**
+ * @brief Stops the analysis and waits for its thread. Call it before any
+ *        other search.
+ *
+ * @param analysis The analysis.
+ */
+void stopLiveAnalysis(LiveAnalysis &analysis);
+
+/**
+ * @brief Returns the latest published results without waiting.
+ *
+ * @param analysis The analysis.
+ * @return The results, valid until the next call.
+ */
+LiveAnalysisSnapshot const &readLiveAnalysis(LiveAnalysis &analysis);
+
+#endif
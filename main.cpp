@@ -5,16 +5,26 @@
  * @copyright Copyright (c) 2023-2024
  */
 
+#include "ai.h"
 #include "model.h"
 #include "view.h"
 #include "controller.h"
+#include "config.h"
+
+static void drawSearchProgress(GameModel &model)
+{
+    Moves noMoves;
+    drawView(model, noMoves, nullptr);
+}
 
 int main()
 {
     GameModel model;
 
+    loadConfig(CONFIG_DEFAULT_PATH);
     initModel(model);
     initView();
+    setSearchProgressCallback(drawSearchProgress);
 
     while (updateView(model))
         ;
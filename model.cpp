@@ -11,35 +11,63 @@
 
 #include "raylib.h"
 
+#include "bitboard.h"
 #include "model.h"
 
+// Guarda la posicion actual en su lugar del anillo
+static void saveSnapshot(GameModel &model)
+{
+    Bitboard board = getBitboard(model.tree);
+    PositionSnapshot &snapshot = model.history[model.historyPly % MODEL_HISTORY_SIZE];
+
+    snapshot.black = board.black;
+    snapshot.white = board.white;
+    snapshot.currentPlayer = (uint8_t)model.tree.currentPlayer;
+}
+
 void initModel(GameModel &model)
 {
     model.tree.gameOver = true;
+    model.tree.currentPlayer = PLAYER_BLACK;
+    model.version = 0;
 
     model.playerTime[0] = 0;
     model.playerTime[1] = 0;
 
     memset(model.tree.board, PIECE_EMPTY, sizeof(model.tree.board));
+
+    model.historyPly = 0;
+    model.historyEnd = 0;
+    saveSnapshot(model);
+}
+
+void startState(tree_logic &tree)
+{
+    tree.gameOver = false;
+    tree.currentPlayer = PLAYER_BLACK;
+
+    memset(tree.board, PIECE_EMPTY, sizeof(tree.board));
+    tree.board[BOARD_SIZE / 2 - 1][BOARD_SIZE / 2 - 1] = PIECE_WHITE;
+    tree.board[BOARD_SIZE / 2 - 1][BOARD_SIZE / 2] = PIECE_BLACK;
+    tree.board[BOARD_SIZE / 2][BOARD_SIZE / 2] = PIECE_WHITE;
+    tree.board[BOARD_SIZE / 2][BOARD_SIZE / 2 - 1] = PIECE_BLACK;
 }
 
 void startModel(GameModel &model)
 {
-    model.tree.gameOver = false;
+    startState(model.tree);
     model.first_human_try = true;
 
-    model.tree.currentPlayer = PLAYER_BLACK;
-
     model.playerTime[0] = 0;
     model.playerTime[1] = 0;
     model.turnTimer = GetTime();
 
-    memset(model.tree.board, PIECE_EMPTY, sizeof(model.tree.board));
-    model.tree.board[BOARD_SIZE / 2 - 1][BOARD_SIZE / 2 - 1] = PIECE_WHITE;
-    model.tree.board[BOARD_SIZE / 2 - 1][BOARD_SIZE / 2] = PIECE_BLACK;
-    model.tree.board[BOARD_SIZE / 2][BOARD_SIZE / 2] = PIECE_WHITE;
-    model.tree.board[BOARD_SIZE / 2][BOARD_SIZE / 2 - 1] = PIECE_BLACK;
     model.moveHistory.clear();
+    model.version++;
+
+    model.historyPly = 0;
+    model.historyEnd = 0;
+    saveSnapshot(model);
 }
 
 Player getCurrentPlayer(GameModel const&model)
@@ -253,6 +281,8 @@ bool playMove(GameModel &model, Square move)
             : PIECE_BLACK;
 
     setBoardPiece(model, move, piece);
+    // Una jugada nueva descarta las que se podian rehacer
+    model.moveHistory.resize(model.historyPly);
     model.moveHistory.push_back(move);
 
     for(int dx = -1; dx <= 1; dx++){
@@ -311,10 +341,52 @@ bool playMove(GameModel &model, Square move)
 
     //reseteo valid moves
     model.human_moves.clear();
+    model.version++;
+
+    model.historyPly++;
+    model.historyEnd = model.historyPly;
+    saveSnapshot(model);
 
     return true;
 }
 
+bool goToModelMove(GameModel &model, int ply)
+{
+    // El anillo solo guarda las ultimas MODEL_HISTORY_SIZE posiciones
+    if (ply < 0 || ply > model.historyEnd || ply <= model.historyEnd - MODEL_HISTORY_SIZE)
+        return false;
+
+    // El tiempo del turno interrumpido se le cuenta a quien estaba jugando
+    double currentTime = GetTime();
+    if (!model.tree.gameOver)
+        model.playerTime[model.tree.currentPlayer] += currentTime - model.turnTimer;
+    model.turnTimer = currentTime;
+
+    PositionSnapshot const&snapshot = model.history[ply % MODEL_HISTORY_SIZE];
+    model.tree = getTreeLogic(Bitboard{snapshot.black, snapshot.white}, (Player)snapshot.currentPlayer);
+    model.historyPly = ply;
+
+    model.first_human_try = true;
+    model.human_moves.clear();
+    model.version++;
+    return true;
+}
+
+bool undoModel(GameModel &model)
+{
+    return goToModelMove(model, model.historyPly - 1);
+}
+
+bool redoModel(GameModel &model)
+{
+    return (model.historyPly < model.historyEnd) && goToModelMove(model, model.historyPly + 1);
+}
+
+int getModelMoveCount(GameModel const&model)
+{
+    return model.historyEnd;
+}
+
 bool playMove(tree_logic &tree, Square move)
 {
     // Set game piece
@@ -374,6 +446,119 @@ bool playMove(tree_logic &tree, Square move)
     return true;
 }
 
+bool hasValidMoves(tree_logic const&tree)
+{
+    for(int y = 0; y < BOARD_SIZE; y++){
+        for(int x = 0; x < BOARD_SIZE; x++){
+            Square currentSquare = {x, y};
+
+            if(getBoardPiece(tree, currentSquare) != PIECE_EMPTY){
+                continue;
+            }
+
+            for(int dx = -1; dx <= 1; dx++){
+                for(int dy = -1; dy <= 1; dy++){
+                    if(dx == 0 && dy == 0){
+                        continue;
+                    }
+
+                    if(checkDirection(tree, currentSquare, dx, dy) > 0){
+                        return true;    //con una sola jugada alcanza, no hace falta listarlas.
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+FlipMask makeMove(tree_logic &tree, Square move, UndoStack &undo)
+{
+    Piece piece =
+        (getCurrentPlayer(tree) == PLAYER_WHITE)
+            ? PIECE_WHITE
+            : PIECE_BLACK;
+
+    MoveUndo &entry = undo.entries[undo.size++];
+    entry.square = move;
+    entry.flips = 0;
+    entry.previousPlayer = tree.currentPlayer;
+    entry.previousGameOver = tree.gameOver;
+
+    // Primero calculamos todas las direcciones sobre el tablero original,
+    // igual que playMove, y despues volteamos.
+    for(int dx = -1; dx <= 1; dx++){
+        for(int dy = -1; dy <= 1; dy++){
+            if(dx == 0 && dy == 0){
+                continue;
+            }
+
+            int enemies = checkDirection(tree, move, dx, dy);
+            Square currentPos = {move.x + dx, move.y + dy};
+
+            for(int i = 0; i < enemies; i++){
+                entry.flips |= (FlipMask)1 << (currentPos.y * BOARD_SIZE + currentPos.x);
+                currentPos.x += dx;
+                currentPos.y += dy;
+            }
+        }
+    }
+
+    setBoardPiece(tree, move, piece);
+
+    FlipMask pending = entry.flips;
+    while(pending){
+        int index = __builtin_ctzll(pending);
+        tree.board[index / BOARD_SIZE][index % BOARD_SIZE] = piece;
+        pending &= pending - 1;
+    }
+
+    // Swap player
+    tree.currentPlayer =
+        (tree.currentPlayer == PLAYER_WHITE)
+            ? PLAYER_BLACK
+            : PLAYER_WHITE;
+
+    // Game over?
+    if (!hasValidMoves(tree))
+    {
+        // Swap player
+        tree.currentPlayer =
+            (tree.currentPlayer == PLAYER_WHITE)
+                ? PLAYER_BLACK
+                : PLAYER_WHITE;
+
+        if (!hasValidMoves(tree))
+            tree.gameOver = true;
+    }
+
+    return entry.flips;
+}
+
+void undoMove(tree_logic &tree, UndoStack &undo)
+{
+    MoveUndo &entry = undo.entries[--undo.size];
+
+    // Las fichas volteadas eran del rival de quien jugo.
+    Piece opponentPiece =
+        (entry.previousPlayer == PLAYER_WHITE)
+            ? PIECE_BLACK
+            : PIECE_WHITE;
+
+    setBoardPiece(tree, entry.square, PIECE_EMPTY);
+
+    FlipMask pending = entry.flips;
+    while(pending){
+        int index = __builtin_ctzll(pending);
+        tree.board[index / BOARD_SIZE][index % BOARD_SIZE] = opponentPiece;
+        pending &= pending - 1;
+    }
+
+    tree.currentPlayer = entry.previousPlayer;
+    tree.gameOver = entry.previousGameOver;
+}
+
 tree_logic gameStateFromModel(GameModel const& model)
 {
     tree_logic state;
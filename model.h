@@ -47,6 +47,36 @@ struct tree_logic
     Piece board[BOARD_SIZE][BOARD_SIZE];
 };
 
+// Bit (y * BOARD_SIZE + x) de la mascara corresponde a la casilla {x, y}
+typedef uint64_t FlipMask;
+
+struct MoveUndo
+{
+    Square square;
+    FlipMask flips;
+    Player previousPlayer;
+    bool previousGameOver;
+};
+
+#define UNDO_STACK_SIZE (BOARD_SIZE * BOARD_SIZE)
+
+struct UndoStack
+{
+    MoveUndo entries[UNDO_STACK_SIZE];
+    int size;
+};
+
+
+// Posicion de la partida para deshacer y rehacer: 17 bytes
+struct PositionSnapshot
+{
+    uint64_t black;
+    uint64_t white;
+    uint8_t currentPlayer;
+} __attribute__((packed));
+
+// Anillo de posiciones: mas que las jugadas de una partida mas la inicial
+#define MODEL_HISTORY_SIZE 64
 
 struct GameModel
 {   
@@ -57,6 +87,10 @@ struct GameModel
     Player humanPlayer;
     Moves human_moves;
     std::vector<Square> moveHistory;
+    int version;                // cambia con cada jugada o partida nueva: la vista redibuja entonces
+    PositionSnapshot history[MODEL_HISTORY_SIZE];   // posicion despues de cada jugada, por ply % tamaño
+    int historyPly;             // jugadas hasta la posicion actual
+    int historyEnd;             // jugadas hasta la ultima que se puede rehacer = moveHistory.size()
 };
 
 
@@ -77,6 +111,13 @@ void initModel(GameModel &model);
  */
 void startModel(GameModel &model);
 
+/**
+ * @brief Sets up the starting position.
+ *
+ * @param tree The tree logic state.
+ */
+void startState(tree_logic &tree);
+
 /**
  * @brief Returns the model's current player.
  *
@@ -198,6 +239,67 @@ bool playMove(GameModel &model, Square move);
  */
 bool playMove(tree_logic &tree, Square move);
 
+/**
+ * @brief Takes back the last move. The moves taken back can be redone
+ *        until a different move is played.
+ *
+ * @param model The game model.
+ * @return There was a move to take back.
+ */
+bool undoModel(GameModel &model);
+
+/**
+ * @brief Plays again the next move taken back.
+ *
+ * @param model The game model.
+ * @return There was a move to redo.
+ */
+bool redoModel(GameModel &model);
+
+/**
+ * @brief Moves to the position after a number of moves of the game, without
+ *        replaying them.
+ *
+ * @param model The game model.
+ * @param ply The number of moves, from 0 to getModelMoveCount.
+ * @return The position is available.
+ */
+bool goToModelMove(GameModel &model, int ply);
+
+/**
+ * @brief Returns the number of moves that can be redone from the start.
+ *
+ * @param model The game model.
+ * @return The number of moves.
+ */
+int getModelMoveCount(GameModel const &model);
+
+/**
+ * @brief Plays a move in place, pushing what is needed to revert it.
+ *
+ * @param tree The tree logic state.
+ * @param move The move.
+ * @param undo The undo stack that receives the flip mask and previous flags.
+ * @return The mask of flipped pieces.
+ */
+FlipMask makeMove(tree_logic &tree, Square move, UndoStack &undo);
+
+/**
+ * @brief Reverts the last move pushed by makeMove.
+ *
+ * @param tree The tree logic state.
+ * @param undo The undo stack.
+ */
+void undoMove(tree_logic &tree, UndoStack &undo);
+
+/**
+ * @brief Checks whether the current player has at least one valid move.
+ *
+ * @param tree The tree logic state.
+ * @return True or false.
+ */
+bool hasValidMoves(tree_logic const&tree);
+
 /**
  * @brief Checks the amount of enemy pieces around an empty square.
  *
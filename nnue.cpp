@@ -0,0 +1,246 @@
+/**
+ * @brief Small quantized neural evaluation with an incremental first layer
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NNUE_X86
+#endif
+
+#include "ai.h"
+#include "bitboard.h"
+#include "nnue.h"
+
+#define NNUE_MAGIC "EDANNUE1"
+
+struct NnueHeader
+{
+    char magic[8];
+    uint32_t inputs;
+    uint32_t hidden1;
+    uint32_t hidden2;
+    uint32_t reserved;
+};
+
+bool loadNnue(const char *path, NnueNetwork &network)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    NnueHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              memcmp(header.magic, NNUE_MAGIC, sizeof(header.magic)) == 0 &&
+              header.inputs == NNUE_INPUTS && header.hidden1 == NNUE_HIDDEN1 &&
+              header.hidden2 == NNUE_HIDDEN2 &&
+              fread(&network, sizeof(network), 1, file) == 1;
+
+    fclose(file);
+    return ok;
+}
+
+bool saveNnue(const char *path, NnueNetwork const&network)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    NnueHeader header;
+    memcpy(header.magic, NNUE_MAGIC, sizeof(header.magic));
+    header.inputs = NNUE_INPUTS;
+    header.hidden1 = NNUE_HIDDEN1;
+    header.hidden2 = NNUE_HIDDEN2;
+    header.reserved = 0;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(&network, sizeof(network), 1, file) == 1;
+    return (fclose(file) == 0) && ok;
+}
+
+// Version AVX2 si la CPU la tiene; el binario sigue andando en cualquier x86
+static bool detectAvx2()
+{
+#ifdef NNUE_X86
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+static const bool g_avx2 = detectAvx2();
+
+bool isNnueAvx2()
+{
+    return g_avx2;
+}
+
+static void addColumnScalar(int16_t *values, int16_t const*column)
+{
+    for (int i = 0; i < NNUE_HIDDEN1; i++)
+        values[i] += column[i];
+}
+
+// Volteo: sale la columna del rival y entra la del que movio
+static void flipColumnsScalar(int16_t *values, int16_t const*added, int16_t const*removed)
+{
+    for (int i = 0; i < NNUE_HIDDEN1; i++)
+        values[i] += added[i] - removed[i];
+}
+
+static int evaluateScalar(NnueNetwork const&network, int16_t const*accumulator)
+{
+    uint8_t hidden1[NNUE_HIDDEN1];
+    for (int i = 0; i < NNUE_HIDDEN1; i++)
+        hidden1[i] = (uint8_t)std::min(std::max((int)accumulator[i], 0), NNUE_ACTIVATION_SCALE);
+
+    int32_t output = network.outputBias;
+    for (int j = 0; j < NNUE_HIDDEN2; j++)
+    {
+        int32_t sum = network.hiddenBias[j];
+        for (int i = 0; i < NNUE_HIDDEN1; i++)
+            sum += hidden1[i] * network.hiddenWeights[j][i];
+
+        int hidden2 = std::min(std::max(sum / NNUE_WEIGHT_SCALE, 0), NNUE_ACTIVATION_SCALE);
+        output += hidden2 * network.outputWeights[j];
+    }
+    return output;
+}
+
+#ifdef NNUE_X86
+__attribute__((target("avx2")))
+static void addColumnAvx2(int16_t *values, int16_t const*column)
+{
+    for (int i = 0; i < NNUE_HIDDEN1; i += 16)
+    {
+        __m256i v = _mm256_loadu_si256((__m256i const*)(values + i));
+        __m256i c = _mm256_loadu_si256((__m256i const*)(column + i));
+        _mm256_storeu_si256((__m256i *)(values + i), _mm256_add_epi16(v, c));
+    }
+}
+
+__attribute__((target("avx2")))
+static void flipColumnsAvx2(int16_t *values, int16_t const*added, int16_t const*removed)
+{
+    for (int i = 0; i < NNUE_HIDDEN1; i += 16)
+    {
+        __m256i v = _mm256_loadu_si256((__m256i const*)(values + i));
+        __m256i a = _mm256_loadu_si256((__m256i const*)(added + i));
+        __m256i r = _mm256_loadu_si256((__m256i const*)(removed + i));
+        _mm256_storeu_si256((__m256i *)(values + i), _mm256_sub_epi16(_mm256_add_epi16(v, a), r));
+    }
+}
+
+// Activaciones de 8 bits sin signo por pesos de 8 bits con signo: maddubs
+// suma pares en 16 bits (127 * 127 * 2 no satura) y madd los lleva a 32
+__attribute__((target("avx2")))
+static int evaluateAvx2(NnueNetwork const&network, int16_t const*accumulator)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i top = _mm256_set1_epi16(NNUE_ACTIVATION_SCALE);
+    __m256i ones = _mm256_set1_epi16(1);
+
+    __m256i hidden1[NNUE_HIDDEN1 / 32];
+    for (int i = 0; i < NNUE_HIDDEN1 / 32; i++)
+    {
+        __m256i low = _mm256_loadu_si256((__m256i const*)(accumulator + 32 * i));
+        __m256i high = _mm256_loadu_si256((__m256i const*)(accumulator + 32 * i + 16));
+        low = _mm256_min_epi16(_mm256_max_epi16(low, zero), top);
+        high = _mm256_min_epi16(_mm256_max_epi16(high, zero), top);
+        // packus intercala por carriles de 128 bits: se reordena con permute
+        hidden1[i] = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xd8);
+    }
+
+    int32_t output = network.outputBias;
+    for (int j = 0; j < NNUE_HIDDEN2; j++)
+    {
+        __m256i sum = zero;
+        for (int i = 0; i < NNUE_HIDDEN1 / 32; i++)
+        {
+            __m256i weights = _mm256_loadu_si256((__m256i const*)(network.hiddenWeights[j] + 32 * i));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(hidden1[i], weights), ones));
+        }
+
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4e));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xb1));
+        int32_t total = network.hiddenBias[j] + _mm_cvtsi128_si32(half);
+
+        int hidden2 = std::min(std::max(total / NNUE_WEIGHT_SCALE, 0), NNUE_ACTIVATION_SCALE);
+        output += hidden2 * network.outputWeights[j];
+    }
+    return output;
+}
+#endif
+
+static void addColumn(int16_t *values, int16_t const*column)
+{
+#ifdef NNUE_X86
+    if (g_avx2)
+        return addColumnAvx2(values, column);
+#endif
+    addColumnScalar(values, column);
+}
+
+static void flipColumns(int16_t *values, int16_t const*added, int16_t const*removed)
+{
+#ifdef NNUE_X86
+    if (g_avx2)
+        return flipColumnsAvx2(values, added, removed);
+#endif
+    flipColumnsScalar(values, added, removed);
+}
+
+void resetNnueAccumulator(NnueNetwork const&network, tree_logic const&tree,
+                          NnueAccumulator &accumulator)
+{
+    memcpy(accumulator.values, network.inputBias, sizeof(accumulator.values));
+
+    Bitboard board = getBitboard(tree);
+    for (uint64_t black = board.black; black; black &= black - 1)
+        addColumn(accumulator.values, network.inputWeights[__builtin_ctzll(black)]);
+    for (uint64_t white = board.white; white; white &= white - 1)
+        addColumn(accumulator.values, network.inputWeights[NNUE_SQUARES + __builtin_ctzll(white)]);
+}
+
+void updateNnueAccumulator(NnueNetwork const&network, NnueAccumulator &accumulator,
+                           Square move, FlipMask flips, Player mover)
+{
+    int own = (mover == PLAYER_BLACK) ? 0 : NNUE_SQUARES;
+    int other = NNUE_SQUARES - own;
+
+    addColumn(accumulator.values, network.inputWeights[own + move.y * BOARD_SIZE + move.x]);
+    for (; flips; flips &= flips - 1)
+    {
+        int square = __builtin_ctzll(flips);
+        flipColumns(accumulator.values, network.inputWeights[own + square],
+                    network.inputWeights[other + square]);
+    }
+}
+
+int evaluateNnue(NnueNetwork const&network, NnueAccumulator const&accumulator, Player currentPlayer)
+{
+    NnueAccumulator turn;
+    int16_t const*values = accumulator.values;
+    if (currentPlayer == PLAYER_WHITE)
+    {
+        turn = accumulator;
+        addColumn(turn.values, network.inputWeights[NNUE_WHITE_TO_MOVE]);
+        values = turn.values;
+    }
+
+#ifdef NNUE_X86
+    int output = g_avx2 ? evaluateAvx2(network, values) : evaluateScalar(network, values);
+#else
+    int output = evaluateScalar(network, values);
+#endif
+
+    // La salida entera es la diferencia final de fichas por 127
+    return (int)((int64_t)output * FINAL_DISC_VALUE / NNUE_ACTIVATION_SCALE);
+}
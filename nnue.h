@@ -0,0 +1,102 @@
+/**
+ * @brief Small quantized neural evaluation with an incremental first layer
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <cstdint>
+
+#include "model.h"
+
+// Entradas: 64 casillas con ficha negra, 64 con ficha blanca y una que vale
+// 1 si mueven las blancas. La primera capa se lleva en un acumulador que se
+// actualiza con la mascara de volteos de cada jugada; las demas son densas.
+#define NNUE_SQUARES (BOARD_SIZE * BOARD_SIZE)
+#define NNUE_INPUTS (2 * NNUE_SQUARES + 1)
+#define NNUE_WHITE_TO_MOVE (2 * NNUE_SQUARES)
+#define NNUE_HIDDEN1 64
+#define NNUE_HIDDEN2 32
+
+// Escalas de la cuantizacion: las activaciones van de 0 a 1 en flotante y
+// de 0 a 127 en entero; los pesos de las capas densas se multiplican por 64
+#define NNUE_ACTIVATION_SCALE 127
+#define NNUE_WEIGHT_SCALE 64
+
+struct NnueNetwork
+{
+    int16_t inputWeights[NNUE_INPUTS][NNUE_HIDDEN1];
+    int16_t inputBias[NNUE_HIDDEN1];
+    int8_t hiddenWeights[NNUE_HIDDEN2][NNUE_HIDDEN1];
+    int32_t hiddenBias[NNUE_HIDDEN2];
+    int8_t outputWeights[NNUE_HIDDEN2];
+    int32_t outputBias;
+};
+
+// Primera capa sin la entrada del turno, que se suma al evaluar
+struct NnueAccumulator
+{
+    int16_t values[NNUE_HIDDEN1];
+};
+
+/**
+ * @brief Loads a network written by saveNnue.
+ *
+ * @param path The file.
+ * @param network Receives the network.
+ * @return Loaded.
+ */
+bool loadNnue(const char *path, NnueNetwork &network);
+
+/**
+ * @brief Writes a network.
+ *
+ * @param path The file.
+ * @param network The network.
+ * @return Written.
+ */
+bool saveNnue(const char *path, NnueNetwork const &network);
+
+/**
+ * @brief Computes the accumulator of a position from scratch.
+ *
+ * @param network The network.
+ * @param tree The position.
+ * @param accumulator Receives the first layer.
+ */
+void resetNnueAccumulator(NnueNetwork const &network, tree_logic const &tree,
+                          NnueAccumulator &accumulator);
+
+/**
+ * @brief Updates an accumulator with a move, as played by makeMove.
+ *
+ * @param network The network.
+ * @param accumulator The first layer before the move, updated in place.
+ * @param move The square played.
+ * @param flips The discs flipped by the move.
+ * @param mover The player who moved.
+ */
+void updateNnueAccumulator(NnueNetwork const &network, NnueAccumulator &accumulator,
+                           Square move, FlipMask flips, Player mover);
+
+/**
+ * @brief Evaluates a position from its accumulator.
+ *
+ * @param network The network.
+ * @param accumulator The first layer of the position.
+ * @param currentPlayer The player to move.
+ * @return The expected final disc difference for black, times FINAL_DISC_VALUE.
+ */
+int evaluateNnue(NnueNetwork const &network, NnueAccumulator const &accumulator, Player currentPlayer);
+
+/**
+ * @brief Tells whether inference runs on AVX2 or on the scalar fallback.
+ *
+ * @return AVX2 is available on this CPU.
+ */
+bool isNnueAvx2();
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @brief Multi-ProbCut parameters for the Reversi game AI
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <cstdio>
+#include <string>
+
+#include "probcut.h"
+
+void initProbCutTable(ProbCutTable &table)
+{
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+        for (int height = 0; height <= PROBCUT_MAX_HEIGHT; height++)
+        {
+            ProbCutPair &pair = table.pairs[stage][height];
+            pair.valid = false;
+            pair.shallowDepth = getProbCutShallowDepth(height);
+            pair.a = 1;
+            pair.b = 0;
+            pair.sigma = 0;
+        }
+}
+
+int getProbCutShallowDepth(int height)
+{
+    // Misma paridad que la busqueda profunda para no mezclar el sesgo de
+    // quien juega ultimo en las hojas
+    int shallow = height - 2;
+    while (shallow > 1 && shallow > height / 2 + 1)
+        shallow -= 2;
+    return (shallow < 1) ? 1 : shallow;
+}
+
+// Cada par se guarda como "height_<h> = <shallow> <a> <b> <sigma>"
+bool loadProbCutTable(const char *path, ProbCutTable &table)
+{
+    std::map<std::string, std::string> values;
+    initProbCutTable(table);
+
+    if (!parseIniFile(path, values))
+        return false;
+
+    for (auto &kv : values)
+    {
+        char stageName[32];
+        int height;
+        ProbCutPair pair;
+
+        if (sscanf(kv.first.c_str(), "%31[^.].height_%d", stageName, &height) != 2 ||
+            sscanf(kv.second.c_str(), "%d %lf %lf %lf",
+                   &pair.shallowDepth, &pair.a, &pair.b, &pair.sigma) != 4)
+        {
+            printf("%s: entrada invalida '%s'\n", path, kv.first.c_str());
+            continue;
+        }
+
+        for (int stage = 0; stage < STAGE_COUNT; stage++)
+        {
+            if (getStageName((GameStage)stage) == std::string(stageName) &&
+                height >= PROBCUT_MIN_HEIGHT && height <= PROBCUT_MAX_HEIGHT &&
+                pair.shallowDepth > 0 && pair.shallowDepth < height && pair.a > 0)
+            {
+                pair.valid = true;
+                table.pairs[stage][height] = pair;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool saveProbCutTable(const char *path, ProbCutTable const&table)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "# Generado por tools/probcut_calibrate\n");
+    fprintf(file, "# height_<h> = <profundidad corta> <a> <b> <sigma>\n");
+
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        fprintf(file, "\n[%s]\n", getStageName((GameStage)stage));
+
+        for (int height = PROBCUT_MIN_HEIGHT; height <= PROBCUT_MAX_HEIGHT; height++)
+        {
+            ProbCutPair const&pair = table.pairs[stage][height];
+            if (!pair.valid)
+                continue;
+            fprintf(file, "height_%d = %d %.4f %.2f %.2f\n",
+                    height, pair.shallowDepth, pair.a, pair.b, pair.sigma);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
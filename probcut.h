@@ -0,0 +1,66 @@
+/**
+ * @brief Multi-ProbCut parameters for the Reversi game AI
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef PROBCUT_H
+#define PROBCUT_H
+
+#include "config.h"
+
+#define PROBCUT_MIN_HEIGHT 3
+#define PROBCUT_MAX_HEIGHT 10
+
+// Prediccion lineal del valor profundo a partir de una busqueda corta:
+// deep ~= a * shallow + b, con error tipico sigma.
+struct ProbCutPair
+{
+    bool valid;
+    int shallowDepth;
+    double a;
+    double b;
+    double sigma;
+};
+
+// Un par por etapa y por altura restante del nodo
+struct ProbCutTable
+{
+    ProbCutPair pairs[STAGE_COUNT][PROBCUT_MAX_HEIGHT + 1];
+};
+
+/**
+ * @brief Marks every pair of a table as not calibrated.
+ *
+ * @param table The table.
+ */
+void initProbCutTable(ProbCutTable &table);
+
+/**
+ * @brief Reads a table written by saveProbCutTable.
+ *
+ * @param path The file.
+ * @param table The table.
+ * @return File read.
+ */
+bool loadProbCutTable(const char *path, ProbCutTable &table);
+
+/**
+ * @brief Writes a table as an INI file with one section per stage.
+ *
+ * @param path The file.
+ * @param table The table.
+ * @return File written.
+ */
+bool saveProbCutTable(const char *path, ProbCutTable const&table);
+
+/**
+ * @brief Shallow search depth used to predict a search of some height.
+ *
+ * @param height The remaining depth of the deep search.
+ * @return The shallow depth.
+ */
+int getProbCutShallowDepth(int height);
+
+#endif
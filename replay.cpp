@@ -0,0 +1,182 @@
+/**
+ * @brief Log of AI decisions for deterministic replay
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "replay.h"
+
+static std::string formatSquare(Square square)
+{
+    if (!isSquareValid(square))
+        return "--";
+
+    std::string text;
+    text += (char)('A' + square.x);
+    text += (char)('1' + square.y);
+    return text;
+}
+
+static Square parseSquare(std::string const&text)
+{
+    Square square = GAME_INVALID_SQUARE;
+    if (text.size() == 2 && text != "--")
+        square = {text[0] - 'A', text[1] - '1'};
+    return square;
+}
+
+static char formatPlayer(Player player)
+{
+    return (player == PLAYER_BLACK) ? 'X' : 'O';
+}
+
+static bool parsePlayer(std::string const&text, Player &player)
+{
+    if (text != "X" && text != "O")
+        return false;
+    player = (text == "X") ? PLAYER_BLACK : PLAYER_WHITE;
+    return true;
+}
+
+static std::string formatBoard(tree_logic const&state)
+{
+    std::string board;
+    for (int y = 0; y < BOARD_SIZE; y++)
+        for (int x = 0; x < BOARD_SIZE; x++)
+        {
+            Piece piece = state.board[y][x];
+            board += (piece == PIECE_BLACK) ? 'X' : (piece == PIECE_WHITE) ? 'O' : '-';
+        }
+    return board;
+}
+
+static bool parseBoard(std::string const&text, tree_logic &state)
+{
+    if (text.size() != BOARD_SIZE * BOARD_SIZE)
+        return false;
+
+    for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++)
+    {
+        char c = text[i];
+        if (c != 'X' && c != 'O' && c != '-')
+            return false;
+        state.board[i / BOARD_SIZE][i % BOARD_SIZE] =
+            (c == 'X') ? PIECE_BLACK : (c == 'O') ? PIECE_WHITE : PIECE_EMPTY;
+    }
+    return true;
+}
+
+bool appendDecisionConfig(const char *path, int id, std::map<std::string, std::string> const&values)
+{
+    FILE *file = fopen(path, "a");
+    if (!file)
+        return false;
+
+    fprintf(file, "config\t%d", id);
+    for (auto const&kv : values)
+        fprintf(file, "\t%s=%s", kv.first.c_str(), kv.second.c_str());
+    fprintf(file, "\n");
+
+    return fclose(file) == 0;
+}
+
+bool appendDecision(const char *path, DecisionRecord const&record)
+{
+    FILE *file = fopen(path, "a");
+    if (!file)
+        return false;
+
+    fprintf(file, "decision\t%d\t%s\t%c\t%c\t%.6f\t%s\t%d\t%d\t%d\t%.6f\t%d\t%d\n",
+            record.config, formatBoard(record.state).c_str(),
+            formatPlayer(record.state.currentPlayer), formatPlayer(record.aiPlayer),
+            record.remainingTime, formatSquare(record.result.bestMove).c_str(),
+            record.result.value, record.result.depth, record.result.nodes, record.seconds,
+            (int)record.book, (int)record.result.outOfTime);
+
+    return fclose(file) == 0;
+}
+
+static bool parseDecision(std::vector<std::string> const&fields, DecisionRecord &record)
+{
+    if (fields.size() != 13)
+        return false;
+
+    record.config = atoi(fields[1].c_str());
+    record.state.gameOver = false;
+    if (!parseBoard(fields[2], record.state) ||
+        !parsePlayer(fields[3], record.state.currentPlayer) ||
+        !parsePlayer(fields[4], record.aiPlayer))
+        return false;
+
+    record.remainingTime = atof(fields[5].c_str());
+    record.result.bestMove = parseSquare(fields[6]);
+    record.result.value = atoi(fields[7].c_str());
+    record.result.depth = atoi(fields[8].c_str());
+    record.result.nodes = atoi(fields[9].c_str());
+    record.result.probCutCuts = 0;
+    record.result.endgameHits = 0;
+    record.result.stabilityCuts = 0;
+    record.result.evalCacheProbes = 0;
+    record.result.evalCacheHits = 0;
+    record.seconds = atof(fields[10].c_str());
+    record.book = atoi(fields[11].c_str()) != 0;
+    record.result.outOfTime = atoi(fields[12].c_str()) != 0;
+    return true;
+}
+
+bool readDecisionLog(const char *path, DecisionLog &log)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    log.configs.clear();
+    log.decisions.clear();
+
+    std::string line;
+    int lineNumber = 0;
+    bool ok = true;
+
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t'))
+            fields.push_back(field);
+
+        if (fields[0] == "config" && fields.size() >= 2)
+        {
+            std::map<std::string, std::string> &values = log.configs[atoi(fields[1].c_str())];
+            for (size_t i = 2; i < fields.size(); i++)
+            {
+                size_t equal = fields[i].find('=');
+                if (equal != std::string::npos)
+                    values[fields[i].substr(0, equal)] = fields[i].substr(equal + 1);
+            }
+            continue;
+        }
+
+        DecisionRecord record;
+        if (fields[0] == "decision" && parseDecision(fields, record))
+        {
+            log.decisions.push_back(record);
+            continue;
+        }
+
+        printf("%s:%d: linea no valida\n", path, lineNumber);
+        ok = false;
+    }
+
+    return ok;
+}
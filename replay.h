@@ -0,0 +1,69 @@
+/**
+ * @brief Log of AI decisions for deterministic replay
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ai.h"
+#include "model.h"
+
+// Una linea por evento, separada por tabuladores:
+//   config <id> <clave=valor>...
+//   decision <config> <tablero> <turno> <ia> <tiempo restante> <jugada> <valor>
+//            <profundidad> <nodos> <segundos> <libro> <cortada por tiempo>
+// El tablero son 64 casillas de A1 a H8 por filas: X negras, O blancas, - vacia.
+
+struct DecisionRecord
+{
+    int config;                 // id de la configuracion con la que se busco
+    tree_logic state;
+    Player aiPlayer;
+    double remainingTime;       // negativo = sin limite
+    SearchResult result;
+    double seconds;
+    bool book;
+};
+
+struct DecisionLog
+{
+    std::map<int, std::map<std::string, std::string>> configs;
+    std::vector<DecisionRecord> decisions;
+};
+
+/**
+ * @brief Appends a configuration to a log.
+ *
+ * @param path The log file.
+ * @param id The id the decisions refer to.
+ * @param values The configuration, as from getConfigValues.
+ * @return Written.
+ */
+bool appendDecisionConfig(const char *path, int id, std::map<std::string, std::string> const &values);
+
+/**
+ * @brief Appends a decision to a log.
+ *
+ * @param path The log file.
+ * @param record The decision.
+ * @return Written.
+ */
+bool appendDecision(const char *path, DecisionRecord const &record);
+
+/**
+ * @brief Reads a whole log.
+ *
+ * @param path The log file.
+ * @param log Receives the configurations and decisions.
+ * @return Read without errors.
+ */
+bool readDecisionLog(const char *path, DecisionLog &log);
+
+#endif
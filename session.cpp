@@ -0,0 +1,279 @@
+/**
+ * @brief Many concurrent AI games in one process, searched by a worker pool
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "config.h"
+#include "gamedb.h"
+#include "session.h"
+
+static double sessionClock()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static Player getAIPlayer(GameSession const&session)
+{
+    return (session.model.humanPlayer == PLAYER_WHITE) ? PLAYER_BLACK : PLAYER_WHITE;
+}
+
+// Encola la busqueda de la IA si le toca mover. Con el manager trabado.
+static void queueIfAITurn(SessionManager &manager, GameSession &session)
+{
+    if (session.pending || session.model.tree.gameOver ||
+        session.model.tree.currentPlayer == session.model.humanPlayer)
+        return;
+
+    session.pending = true;
+    manager.queue.push_back(session.id);
+    manager.wakeup.notify_one();
+}
+
+// Juega una jugada en la partida; el tiempo de cada lado lo lleva el manager
+static void playSessionSquare(GameSession &session, Square move)
+{
+    playMove(session.model.tree, move);
+    session.model.moveHistory.push_back(move);
+    session.model.first_human_try = true;
+    session.model.version++;
+}
+
+// Guarda una partida terminada, copiada antes de soltar el manager: solo se
+// traba el archivo, asi la escritura no frena a las demas partidas
+static void archiveSession(SessionManager &manager, int id, GameModel &model)
+{
+    std::string const&path = getConfig().archivePath;
+    if (path.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(manager.archiveMutex);
+    if (!archiveGame(path.c_str(), model))
+        printf("No se pudo guardar la partida %d en %s\n", id, path.c_str());
+}
+
+static void runWorker(SessionManager *manager)
+{
+    std::unique_lock<std::mutex> lock(manager->mutex);
+
+    while (true)
+    {
+        manager->wakeup.wait(lock, [manager] {
+            return manager->stopping || !manager->queue.empty();
+        });
+        if (manager->stopping)
+            return;
+
+        int id = manager->queue.front();
+        manager->queue.pop_front();
+
+        auto found = manager->sessions.find(id);
+        if (found == manager->sessions.end())
+            continue;
+        GameSession &session = *found->second;
+
+        // El modelo se copia: mientras se busca se puede consultar la partida.
+        // La tabla es de la partida y nadie mas la toca mientras pending.
+        GameModel model = session.model;
+        double remaining = -1;
+        if (session.timeBudget > 0)
+            remaining = std::max(0.0, session.timeBudget - session.timeUsed);
+
+        manager->searching++;
+        lock.unlock();
+
+        double start = sessionClock();
+        SearchResult result = getGameBestMove(model, session.tt, remaining);
+        double elapsed = sessionClock() - start;
+
+        lock.lock();
+        manager->searching--;
+        manager->searches++;
+        session.pending = false;
+        session.timeUsed += elapsed;
+        session.model.playerTime[getAIPlayer(session)] = session.timeUsed;
+
+        if (session.closed)
+        {
+            manager->sessions.erase(id);
+            continue;
+        }
+
+        playSessionSquare(session, result.bestMove);
+        if (manager->onMove != nullptr)
+            manager->onMove(session, result.bestMove, result);
+
+        // Si el rival no puede jugar, la IA vuelve a mover: al final de la cola
+        queueIfAITurn(*manager, session);
+
+        if (session.model.tree.gameOver)
+        {
+            GameModel finished = session.model;
+            lock.unlock();
+            archiveSession(*manager, id, finished);
+            lock.lock();
+        }
+    }
+}
+
+bool startSessionManager(SessionManager &manager, int workers, SessionMoveCallback onMove)
+{
+    prepareSharedSearch();
+
+    if (workers <= 0)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+
+    manager.onMove = onMove;
+    manager.nextId = 1;
+    manager.searching = 0;
+    manager.searches = 0;
+    manager.stopping = false;
+
+    for (int i = 0; i < workers; i++)
+        manager.workers.emplace_back(runWorker, &manager);
+    return true;
+}
+
+void stopSessionManager(SessionManager &manager)
+{
+    {
+        std::lock_guard<std::mutex> lock(manager.mutex);
+        manager.stopping = true;
+    }
+    manager.wakeup.notify_all();
+
+    for (auto &worker : manager.workers)
+        worker.join();
+
+    manager.workers.clear();
+    manager.queue.clear();
+    manager.sessions.clear();
+}
+
+int openSession(SessionManager &manager, Player humanPlayer, double timeBudget)
+{
+    std::unique_ptr<GameSession> session(new GameSession);
+
+    initModel(session->model);
+    startState(session->model.tree);
+    session->model.first_human_try = true;
+    session->model.turnTimer = 0;
+    session->model.humanPlayer = humanPlayer;
+    // Las tablas de cada partida son chicas: no vale la pena redondearlas a 2 MB
+    initTranspositionTable(session->tt, getConfig().serverTTSizeMB, false);
+    session->timeBudget = timeBudget;
+    session->timeUsed = 0;
+    session->pending = false;
+    session->closed = false;
+
+    std::lock_guard<std::mutex> lock(manager.mutex);
+    int id = manager.nextId++;
+    session->id = id;
+    manager.sessions[id] = std::move(session);
+    return id;
+}
+
+bool playSessionMove(SessionManager &manager, int id, Square move, bool &gameOver)
+{
+    GameModel finished;
+    {
+        std::lock_guard<std::mutex> lock(manager.mutex);
+
+        auto found = manager.sessions.find(id);
+        if (found == manager.sessions.end() || found->second->closed)
+            return false;
+
+        GameSession &session = *found->second;
+        if (session.pending || session.model.tree.gameOver ||
+            session.model.tree.currentPlayer != session.model.humanPlayer)
+            return false;
+
+        Moves moves;
+        getValidMoves(session.model.tree, moves);
+        bool valid = false;
+        for (auto candidate : moves)
+            valid |= (candidate.x == move.x) && (candidate.y == move.y);
+        if (!valid)
+            return false;
+
+        playSessionSquare(session, move);
+        gameOver = session.model.tree.gameOver;
+        if (gameOver)
+            finished = session.model;
+    }
+
+    if (gameOver)
+        archiveSession(manager, id, finished);
+    return true;
+}
+
+bool queueSessionReply(SessionManager &manager, int id)
+{
+    std::lock_guard<std::mutex> lock(manager.mutex);
+
+    auto found = manager.sessions.find(id);
+    if (found == manager.sessions.end() || found->second->closed)
+        return false;
+
+    queueIfAITurn(manager, *found->second);
+    return true;
+}
+
+bool closeSession(SessionManager &manager, int id)
+{
+    std::lock_guard<std::mutex> lock(manager.mutex);
+
+    auto found = manager.sessions.find(id);
+    if (found == manager.sessions.end() || found->second->closed)
+        return false;
+
+    // Si esta en la cola el hilo la saltea; si esta buscando la borra al terminar
+    if (found->second->pending)
+        found->second->closed = true;
+    else
+        manager.sessions.erase(found);
+
+    for (auto queued = manager.queue.begin(); queued != manager.queue.end(); ++queued)
+    {
+        if (*queued == id)
+        {
+            manager.queue.erase(queued);
+            manager.sessions.erase(id);
+            break;
+        }
+    }
+    return true;
+}
+
+bool getSessionState(SessionManager &manager, int id, GameModel &model, bool &pending)
+{
+    std::lock_guard<std::mutex> lock(manager.mutex);
+
+    auto found = manager.sessions.find(id);
+    if (found == manager.sessions.end() || found->second->closed)
+        return false;
+
+    model = found->second->model;
+    pending = found->second->pending;
+    return true;
+}
+
+SessionStats getSessionStats(SessionManager &manager)
+{
+    std::lock_guard<std::mutex> lock(manager.mutex);
+
+    SessionStats stats;
+    stats.games = 0;
+    for (auto const&session : manager.sessions)
+        stats.games += !session.second->closed;
+    stats.queued = (int)manager.queue.size();
+    stats.searching = manager.searching;
+    stats.searches = manager.searches;
+    return stats;
+}
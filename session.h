@@ -0,0 +1,151 @@
+/**
+ * @brief Many concurrent AI games in one process, searched by a worker pool
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ai.h"
+#include "model.h"
+#include "transposition.h"
+
+// Una partida contra la IA. La tabla de transposicion es de la partida; el
+// libro, los pesos y la cache de finales son compartidos (prepareSharedSearch).
+struct GameSession
+{
+    int id;
+    GameModel model;
+    TranspositionTable tt;
+    double timeBudget;          // segundos de la IA para toda la partida, 0 = sin limite
+    double timeUsed;
+    bool pending;               // la IA tiene una busqueda en la cola o en curso
+    bool closed;                // cerrada mientras buscaba: la borra el hilo
+};
+
+struct SessionStats
+{
+    int games;
+    int queued;                 // partidas esperando un hilo
+    int searching;              // partidas buscando
+    long searches;              // jugadas de la IA desde que empezo
+};
+
+/**
+ * @brief Called after every AI move, with the manager locked: it must not
+ *        call back into the manager. The game is archived after it returns.
+ *
+ * @param session The game, after the move.
+ * @param move The move played.
+ * @param result The search result (only bestMove for book moves).
+ */
+typedef void (*SessionMoveCallback)(GameSession const &session, Square move, SearchResult const &result);
+
+// Cola justa: cada partida tiene a lo sumo un pedido pendiente y los pedidos
+// se atienden en orden de llegada, asi que ninguna partida espera mas de una
+// vuelta de las demas aunque algunas busquen mucho mas.
+struct SessionManager
+{
+    std::mutex mutex;
+    std::mutex archiveMutex;    // escrituras al archivo de partidas, sin trabar las partidas
+    std::condition_variable wakeup;
+    std::map<int, std::unique_ptr<GameSession>> sessions;
+    std::deque<int> queue;
+    std::vector<std::thread> workers;
+    SessionMoveCallback onMove;
+    int nextId;
+    int searching;
+    long searches;
+    bool stopping;
+};
+
+/**
+ * @brief Loads the shared search resources and starts the worker threads.
+ *
+ * @param manager The manager.
+ * @param workers The amount of threads, 0 for one per core.
+ * @param onMove Called after every AI move, or nullptr.
+ * @return Started.
+ */
+bool startSessionManager(SessionManager &manager, int workers, SessionMoveCallback onMove);
+
+/**
+ * @brief Stops the worker threads, waiting for the searches in progress,
+ *        and closes every game.
+ *
+ * @param manager The manager.
+ */
+void stopSessionManager(SessionManager &manager);
+
+/**
+ * @brief Starts a game. If the AI plays black, queue its first move with
+ *        queueSessionReply once the game id has been reported.
+ *
+ * @param manager The manager.
+ * @param humanPlayer The color of the other side.
+ * @param timeBudget Seconds for all AI moves of the game, 0 for no limit.
+ * @return The game id.
+ */
+int openSession(SessionManager &manager, Player humanPlayer, double timeBudget);
+
+/**
+ * @brief Plays a move of the other side. The AI reply is not queued until
+ *        queueSessionReply, so the move can be acknowledged before any
+ *        reply is reported. A finished game is archived after unlocking.
+ *
+ * @param manager The manager.
+ * @param id The game id.
+ * @param move The move.
+ * @param gameOver Receives whether the move ended the game.
+ * @return The game exists, it is the other side's turn and the move is valid.
+ */
+bool playSessionMove(SessionManager &manager, int id, Square move, bool &gameOver);
+
+/**
+ * @brief Queues the AI move of a game if it is the AI's turn.
+ *
+ * @param manager The manager.
+ * @param id The game id.
+ * @return The game exists.
+ */
+bool queueSessionReply(SessionManager &manager, int id);
+
+/**
+ * @brief Ends a game. A search in progress finishes in the background.
+ *
+ * @param manager The manager.
+ * @param id The game id.
+ * @return The game existed.
+ */
+bool closeSession(SessionManager &manager, int id);
+
+/**
+ * @brief Copies the state of a game.
+ *
+ * @param manager The manager.
+ * @param id The game id.
+ * @param model Receives the game model.
+ * @param pending Receives whether the AI is thinking.
+ * @return The game exists.
+ */
+bool getSessionState(SessionManager &manager, int id, GameModel &model, bool &pending);
+
+/**
+ * @brief Returns counters of the manager.
+ *
+ * @param manager The manager.
+ * @return The counters.
+ */
+SessionStats getSessionStats(SessionManager &manager);
+
+#endif
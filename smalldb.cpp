@@ -0,0 +1,249 @@
+/**
+ * @brief Perfect-play database of the 4x4 and 6x6 variants
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "smalldb.h"
+
+static_assert(sizeof(SmallDatabaseEntry) == 9, "Clave y valor sin relleno");
+
+static uint64_t g_powers[SMALL_DATABASE_MAX_SIZE * SMALL_DATABASE_MAX_SIZE];
+
+static bool initPowers()
+{
+    uint64_t power = 1;
+    for (int i = 0; i < SMALL_DATABASE_MAX_SIZE * SMALL_DATABASE_MAX_SIZE; i++, power *= 3)
+        g_powers[i] = power;
+    return true;
+}
+
+static const bool g_powersReady = initPowers();
+
+// Casilla a la que lleva cada una de las 8 simetrias: transponer, espejar
+// las columnas y espejar las filas
+static int transformSquare(int size, int symmetry, int x, int y)
+{
+    if (symmetry & 4)
+    {
+        int swap = x;
+        x = y;
+        y = swap;
+    }
+    if (symmetry & 1)
+        x = size - 1 - x;
+    if (symmetry & 2)
+        y = size - 1 - y;
+    return y * size + x;
+}
+
+uint64_t smallDatabaseKey(int size, uint64_t own, uint64_t opponent)
+{
+    uint64_t best = UINT64_MAX;
+    for (int symmetry = 0; symmetry < 8; symmetry++)
+    {
+        uint64_t key = 0;
+        for (uint64_t discs = own | opponent; discs; discs &= discs - 1)
+        {
+            int square = __builtin_ctzll(discs);
+            int digit = (own >> square & 1) ? 1 : 2;
+            key += digit * g_powers[transformSquare(size, symmetry, square % size, square / size)];
+        }
+        if (key < best)
+            best = key;
+    }
+    return best;
+}
+
+void decodeSmallDatabaseKey(int size, uint64_t key, uint64_t &own, uint64_t &opponent)
+{
+    own = 0;
+    opponent = 0;
+    for (int square = 0; square < size * size; square++, key /= 3)
+    {
+        if (key % 3 == 1)
+            own |= (uint64_t)1 << square;
+        else if (key % 3 == 2)
+            opponent |= (uint64_t)1 << square;
+    }
+}
+
+static uint64_t hashKey(uint64_t key)
+{
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+bool writeSmallDatabase(const char *path, int size, int minEmpties,
+                        std::vector<SmallDatabaseEntry> const&entries)
+{
+    // Con la mitad de la tabla libre las busquedas fallidas terminan rapido
+    uint64_t capacity = 1;
+    while (capacity < 2 * entries.size())
+        capacity *= 2;
+
+    std::vector<SmallDatabaseEntry> table(capacity);
+    memset(table.data(), 0, capacity * sizeof(SmallDatabaseEntry));
+    for (auto const&entry : entries)
+    {
+        uint64_t slot = hashKey(entry.key) & (capacity - 1);
+        while (table[slot].key != 0)
+            slot = (slot + 1) & (capacity - 1);
+        table[slot] = entry;
+    }
+
+    SmallDatabaseHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SMALL_DATABASE_MAGIC, sizeof(header.magic));
+    header.size = size;
+    header.minEmpties = minEmpties;
+    header.capacity = capacity;
+    header.count = entries.size();
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(table.data(), sizeof(SmallDatabaseEntry), capacity, file) == capacity;
+    return (fclose(file) == 0) && ok;
+}
+
+bool openSmallDatabase(SmallDatabase &db, const char *path)
+{
+    db.header = nullptr;
+    db.entries = nullptr;
+    db.mapping = nullptr;
+    db.mappingSize = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SmallDatabaseHeader))
+    {
+        close(fd);
+        return false;
+    }
+
+    size_t size = info.st_size;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    SmallDatabaseHeader const *header = (SmallDatabaseHeader const *)data;
+    uint64_t capacity = header->capacity;
+    if (memcmp(header->magic, SMALL_DATABASE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->size < 2 || header->size > SMALL_DATABASE_MAX_SIZE || !isVariantSize(header->size) ||
+        capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        size != sizeof(SmallDatabaseHeader) + capacity * sizeof(SmallDatabaseEntry))
+    {
+        munmap(data, size);
+        return false;
+    }
+
+    // Los accesos caen en cualquier lugar del archivo
+    madvise(data, size, MADV_RANDOM);
+
+    db.header = header;
+    db.entries = (SmallDatabaseEntry const *)((uint8_t const *)data + sizeof(SmallDatabaseHeader));
+    db.mapping = data;
+    db.mappingSize = size;
+    return true;
+}
+
+void closeSmallDatabase(SmallDatabase &db)
+{
+    if (db.mapping != nullptr)
+        munmap(db.mapping, db.mappingSize);
+
+    db.header = nullptr;
+    db.entries = nullptr;
+    db.mapping = nullptr;
+    db.mappingSize = 0;
+}
+
+bool probeSmallDatabase(SmallDatabase const&db, uint64_t own, uint64_t opponent, int &value)
+{
+    if (db.mapping == nullptr)
+        return false;
+
+    uint64_t key = smallDatabaseKey(db.header->size, own, opponent);
+    uint64_t mask = db.header->capacity - 1;
+    for (uint64_t slot = hashKey(key) & mask; db.entries[slot].key != 0; slot = (slot + 1) & mask)
+        if (db.entries[slot].key == key)
+        {
+            value = db.entries[slot].value;
+            return true;
+        }
+    return false;
+}
+
+bool probeSmallDatabase(SmallDatabase const&db, VariantState const&state, int &value)
+{
+    if (db.mapping == nullptr || state.size != (int)db.header->size)
+        return false;
+
+    uint64_t own = 0, opponent = 0;
+    for (int y = 0; y < state.size; y++)
+        for (int x = 0; x < state.size; x++)
+        {
+            Piece piece = state.board[y][x];
+            if (piece == PIECE_EMPTY)
+                continue;
+
+            bool mine = (piece == PIECE_BLACK) == (state.currentPlayer == PLAYER_BLACK);
+            (mine ? own : opponent) |= (uint64_t)1 << (y * state.size + x);
+        }
+
+    if (state.gameOver)
+    {
+        value = __builtin_popcountll(own) - __builtin_popcountll(opponent);
+        return true;
+    }
+    return probeSmallDatabase(db, own, opponent, value);
+}
+
+bool getSmallDatabaseMove(SmallDatabase const&db, VariantState const&state, Square &move, int &value)
+{
+    Moves moves;
+    getVariantMoves(state, moves);
+    if (moves.empty())
+        return false;
+
+    int best = -SMALL_DATABASE_MAX_SIZE * SMALL_DATABASE_MAX_SIZE - 1;
+    for (auto candidate : moves)
+    {
+        VariantState child = state;
+        playVariantMove(child, candidate);
+
+        // El valor del hijo es del que mueve en el hijo: el mismo si el rival pasa
+        int childValue;
+        if (!probeSmallDatabase(db, child, childValue))
+            return false;
+        if (child.currentPlayer != state.currentPlayer)
+            childValue = -childValue;
+
+        if (childValue > best)
+        {
+            best = childValue;
+            move = candidate;
+        }
+    }
+
+    value = best;
+    return true;
+}
@@ -0,0 +1,130 @@
+/**
+ * @brief Perfect-play database of the 4x4 and 6x6 variants
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef SMALLDB_H
+#define SMALLDB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "variant.h"
+
+#define SMALL_DATABASE_MAGIC "EDASMALL"
+
+// Tamaño maximo: la clave en base 3 de 6x6 (3^36) todavia entra en 64 bits
+#define SMALL_DATABASE_MAX_SIZE 6
+
+// Resultado final con juego perfecto (fichas del que mueve menos las del
+// rival) de una posicion reducida por simetria
+struct SmallDatabaseEntry
+{
+    uint64_t key;               // smallDatabaseKey, 0 = libre
+    int8_t value;
+} __attribute__((packed));
+
+// Cabecera del archivo, seguida de la tabla de direccionamiento abierto
+struct SmallDatabaseHeader
+{
+    char magic[8];
+    uint32_t size;              // lado del tablero
+    uint32_t minEmpties;        // posiciones con menos casillas vacias no estan
+    uint64_t capacity;          // potencia de dos
+    uint64_t count;
+};
+
+struct SmallDatabase
+{
+    SmallDatabaseHeader const *header;
+    SmallDatabaseEntry const *entries;
+    void *mapping;              // archivo mapeado, nullptr si esta cerrada
+    size_t mappingSize;
+};
+
+/**
+ * @brief Computes the key of a position, the same for its 8 symmetries: the
+ *        smallest base 3 number among them, one digit per square.
+ *
+ * @param size The board size, up to SMALL_DATABASE_MAX_SIZE.
+ * @param own The discs of the player to move (bit y * size + x).
+ * @param opponent The discs of the other player.
+ * @return The key.
+ */
+uint64_t smallDatabaseKey(int size, uint64_t own, uint64_t opponent);
+
+/**
+ * @brief Decodes a key to the bitboards of its canonical symmetry.
+ *
+ * @param size The board size.
+ * @param key The key.
+ * @param own Receives the discs of the player to move.
+ * @param opponent Receives the discs of the other player.
+ */
+void decodeSmallDatabaseKey(int size, uint64_t key, uint64_t &own, uint64_t &opponent);
+
+/**
+ * @brief Writes a database file.
+ *
+ * @param path The file.
+ * @param size The board size.
+ * @param minEmpties The fewest empty squares of the stored positions.
+ * @param entries The positions, with unique keys.
+ * @return Written.
+ */
+bool writeSmallDatabase(const char *path, int size, int minEmpties,
+                        std::vector<SmallDatabaseEntry> const &entries);
+
+/**
+ * @brief Maps a database file read-only.
+ *
+ * @param db The database.
+ * @param path The file.
+ * @return Opened; otherwise the database stays closed.
+ */
+bool openSmallDatabase(SmallDatabase &db, const char *path);
+
+/**
+ * @brief Unmaps a database.
+ *
+ * @param db The database.
+ */
+void closeSmallDatabase(SmallDatabase &db);
+
+/**
+ * @brief Looks up a position with moves for the player to move.
+ *
+ * @param db The database.
+ * @param own The discs of the player to move.
+ * @param opponent The discs of the other player.
+ * @param value Receives the final disc difference for the player to move.
+ * @return The position is in the database.
+ */
+bool probeSmallDatabase(SmallDatabase const &db, uint64_t own, uint64_t opponent, int &value);
+
+/**
+ * @brief Looks up a variant position of the database size, finished games
+ *        included.
+ *
+ * @param db The database.
+ * @param state The position.
+ * @param value Receives the final disc difference for the player to move.
+ * @return The value is known.
+ */
+bool probeSmallDatabase(SmallDatabase const &db, VariantState const &state, int &value);
+
+/**
+ * @brief Chooses a perfect move from the values of every child.
+ *
+ * @param db The database.
+ * @param state The position.
+ * @param move Receives the best move.
+ * @param value Receives its final disc difference for the player to move.
+ * @return Every child is known.
+ */
+bool getSmallDatabaseMove(SmallDatabase const &db, VariantState const &state, Square &move, int &value);
+
+#endif
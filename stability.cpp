@@ -0,0 +1,200 @@
+/**
+ * @brief Stable disc estimation on bitboards
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <cstring>
+
+#include "stability.h"
+
+#define EDGE_STATES 6561            // 3^8
+#define ROW_1 0x00000000000000ffULL
+#define ROW_8 0xff00000000000000ULL
+#define COLUMN_A 0x0101010101010101ULL
+#define COLUMN_H 0x8080808080808080ULL
+#define INNER_SQUARES 0x007e7e7e7e7e7e00ULL
+
+// Junta una columna en un byte: bit y = fila y
+#define COLUMN_PACK 0x0102040810204080ULL
+
+// Tablas calculadas una sola vez al arrancar
+struct StabilityTables
+{
+    uint16_t base3[256];            // bits de un byte leidos en base 3
+    uint8_t edge[EDGE_STATES];      // fichas propias estables de un borde
+    bool solved[EDGE_STATES];
+    uint64_t columnA[256];          // byte -> columna A
+    uint64_t diagonals9[15];        // x - y constante
+    uint64_t diagonals7[15];        // x + y constante
+
+    StabilityTables()
+    {
+        for (int bits = 0; bits < 256; bits++)
+        {
+            base3[bits] = 0;
+            columnA[bits] = 0;
+            for (int i = 7; i >= 0; i--)
+            {
+                base3[bits] = base3[bits] * 3 + ((bits >> i) & 1);
+                if (bits & (1 << i))
+                    columnA[bits] |= (uint64_t)1 << (8 * i);
+            }
+        }
+
+        memset(solved, 0, sizeof(solved));
+        for (int own = 0; own < 256; own++)
+            for (int opponent = 0; opponent < 256; opponent++)
+                if (!(own & opponent))
+                    solveEdge(own, opponent);
+
+        memset(diagonals9, 0, sizeof(diagonals9));
+        memset(diagonals7, 0, sizeof(diagonals7));
+        for (int y = 0; y < 8; y++)
+            for (int x = 0; x < 8; x++)
+            {
+                diagonals9[x - y + 7] |= (uint64_t)1 << (y * 8 + x);
+                diagonals7[x + y] |= (uint64_t)1 << (y * 8 + x);
+            }
+    }
+
+    int index(int own, int opponent) const
+    {
+        return base3[own] + 2 * base3[opponent];
+    }
+
+    // Jugada de mover en la casilla square de una linea de 8, volteando
+    // hacia los dos lados
+    static void playLine(int &mover, int &other, int square)
+    {
+        int flips = 0;
+
+        for (int direction = -1; direction <= 1; direction += 2)
+        {
+            int line = 0;
+            int i = square + direction;
+            while (i >= 0 && i < 8 && (other & (1 << i)))
+            {
+                line |= 1 << i;
+                i += direction;
+            }
+            if (i >= 0 && i < 8 && (mover & (1 << i)))
+                flips |= line;
+        }
+
+        mover |= flips | (1 << square);
+        other &= ~flips;
+    }
+
+    // Las fichas propias que siguen siendo propias despues de cualquier
+    // forma de llenar el borde con fichas de los dos colores. Cualquier
+    // casilla vacia se puede ocupar: la jugada puede ser legal por otra linea.
+    uint8_t solveEdge(int own, int opponent)
+    {
+        int i = index(own, opponent);
+        if (solved[i])
+            return edge[i];
+
+        int stable = own;
+        int empty = ~(own | opponent) & 0xff;
+
+        for (int square = 0; square < 8 && stable; square++)
+        {
+            if (!(empty & (1 << square)))
+                continue;
+
+            int mover = own, other = opponent;
+            playLine(mover, other, square);
+            stable &= solveEdge(mover, other);
+
+            mover = opponent;
+            other = own;
+            playLine(mover, other, square);
+            stable &= solveEdge(other, mover);
+        }
+
+        solved[i] = true;
+        edge[i] = (uint8_t)stable;
+        return edge[i];
+    }
+};
+
+static const StabilityTables g_stability;
+
+static int packColumn(uint64_t bits)
+{
+    return (int)(((bits & COLUMN_A) * COLUMN_PACK) >> 56);
+}
+
+static uint64_t getEdgeStable(uint64_t own, uint64_t opponent)
+{
+    uint64_t stable = 0;
+
+    stable |= g_stability.edge[g_stability.index(own & 0xff, opponent & 0xff)];
+    stable |= (uint64_t)g_stability.edge[g_stability.index(own >> 56, opponent >> 56)] << 56;
+
+    int ownA = packColumn(own), opponentA = packColumn(opponent);
+    stable |= g_stability.columnA[g_stability.edge[g_stability.index(ownA, opponentA)]];
+
+    int ownH = packColumn(own >> 7), opponentH = packColumn(opponent >> 7);
+    stable |= g_stability.columnA[g_stability.edge[g_stability.index(ownH, opponentH)]] << 7;
+
+    return stable;
+}
+
+// Casillas cuya linea en cada direccion esta completa
+static void getFullLines(uint64_t occupied, uint64_t full[4])
+{
+    full[0] = full[1] = full[2] = full[3] = 0;
+
+    for (int i = 0; i < 8; i++)
+    {
+        uint64_t row = ROW_1 << (8 * i);
+        uint64_t column = COLUMN_A << i;
+        if ((occupied & row) == row)
+            full[0] |= row;
+        if ((occupied & column) == column)
+            full[1] |= column;
+    }
+    for (int i = 0; i < 15; i++)
+    {
+        if ((occupied & g_stability.diagonals9[i]) == g_stability.diagonals9[i])
+            full[2] |= g_stability.diagonals9[i];
+        if ((occupied & g_stability.diagonals7[i]) == g_stability.diagonals7[i])
+            full[3] |= g_stability.diagonals7[i];
+    }
+}
+
+uint64_t getStableDiscs(uint64_t own, uint64_t opponent)
+{
+    uint64_t edges = ROW_1 | ROW_8 | COLUMN_A | COLUMN_H;
+    uint64_t stable = getEdgeStable(own, opponent) & own & edges;
+
+    uint64_t full[4];
+    getFullLines(own | opponent, full);
+
+    // Una ficha interior es estable si en cada una de las cuatro lineas la
+    // linea esta completa o tiene al lado una ficha propia estable
+    uint64_t inner = own & INNER_SQUARES;
+    uint64_t candidates = inner & full[0] & full[1] & full[2] & full[3];
+    stable |= candidates;
+
+    uint64_t previous;
+    do
+    {
+        previous = stable;
+        uint64_t horizontal = full[0] | (stable << 1) | (stable >> 1);
+        uint64_t vertical = full[1] | (stable << 8) | (stable >> 8);
+        uint64_t diagonal9 = full[2] | (stable << 9) | (stable >> 9);
+        uint64_t diagonal7 = full[3] | (stable << 7) | (stable >> 7);
+        stable |= inner & horizontal & vertical & diagonal9 & diagonal7;
+    } while (stable != previous);
+
+    return stable;
+}
+
+int countStableDiscs(uint64_t own, uint64_t opponent)
+{
+    return __builtin_popcountll(getStableDiscs(own, opponent));
+}
@@ -0,0 +1,34 @@
+/**
+ * @brief Stable disc estimation on bitboards
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef STABILITY_H
+#define STABILITY_H
+
+#include <cstdint>
+
+/**
+ * @brief Finds discs that can never be flipped again: edge discs from
+ *        precomputed tables of every edge (3^8 entries), and inner discs
+ *        whose four lines are full or touch a stable disc of the same color.
+ *        The estimate is conservative: every disc returned is stable.
+ *
+ * @param own The discs of the player.
+ * @param opponent The opponent's discs.
+ * @return The stable discs of the player.
+ */
+uint64_t getStableDiscs(uint64_t own, uint64_t opponent);
+
+/**
+ * @brief Counts the stable discs of a player.
+ *
+ * @param own The discs of the player.
+ * @param opponent The opponent's discs.
+ * @return The amount of stable discs.
+ */
+int countStableDiscs(uint64_t own, uint64_t opponent);
+
+#endif
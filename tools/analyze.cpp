@@ -0,0 +1,108 @@
+/**
+ * @brief Deep analysis of a position split across worker processes
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ *
+ * Uso: analyze <procesos> <profundidad> [jugadas] [configuracion.ini]
+ *
+ * Las jugadas llevan a la posicion desde la inicial, por ejemplo "F5D6C3".
+ * Profundidad 0 busca hasta el final. Cada jugada de la posicion se busca en
+ * un proceso trabajador; se imprimen los pid para poder matar alguno y ver
+ * que su jugada pasa a otro.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "analysis.h"
+#include "config.h"
+
+static std::string formatSquare(Square square)
+{
+    std::string text;
+    text += (char)('A' + square.x);
+    text += (char)('1' + square.y);
+    return text;
+}
+
+static bool playLine(const char *line, tree_logic &state)
+{
+    startState(state);
+
+    size_t length = strlen(line);
+    if (length % 2 != 0)
+        return false;
+
+    for (size_t i = 0; i < length; i += 2)
+    {
+        Square move = {toupper(line[i]) - 'A', line[i + 1] - '1'};
+        Moves moves;
+        getValidMoves(state, moves);
+
+        bool valid = false;
+        for (auto candidate : moves)
+            valid |= (candidate.x == move.x && candidate.y == move.y);
+        if (!valid || state.gameOver)
+            return false;
+        playMove(state, move);
+    }
+    return !state.gameOver;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        printf("Uso: %s <procesos> <profundidad> [jugadas] [configuracion.ini]\n", argv[0]);
+        return 1;
+    }
+
+    int processes = atoi(argv[1]);
+    int depth = atoi(argv[2]);
+    const char *line = (argc > 3) ? argv[3] : "";
+    loadConfig((argc > 4) ? argv[4] : CONFIG_DEFAULT_PATH);
+
+    tree_logic state;
+    if (processes < 1 || !playLine(line, state))
+    {
+        printf("Jugadas no validas: %s\n", line);
+        return 1;
+    }
+
+    AnalysisCluster cluster;
+    if (!startAnalysisCluster(cluster, processes))
+    {
+        printf("No se pudieron lanzar los trabajadores\n");
+        return 1;
+    }
+    for (auto const&worker : cluster.workers)
+        printf("Trabajador %d\n", (int)worker.pid);
+    fflush(stdout);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<MoveAnalysis> moves;
+    bool complete = analyzePosition(cluster, state, state.currentPlayer, depth, moves);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stopAnalysisCluster(cluster);
+
+    if (!complete)
+    {
+        printf("El analisis no termino: se perdieron los trabajadores\n");
+        return 1;
+    }
+
+    long nodes = 0;
+    for (auto const&move : moves)
+    {
+        printf("%s %8d %s %10d nodos\n", formatSquare(move.move).c_str(), move.value,
+               move.exact ? "exacto" : "cota  ", move.nodes);
+        nodes += move.nodes;
+    }
+    printf("Mejor: %s con %d. %ld nodos en %.2f s, %d trabajadores reemplazados\n",
+           formatSquare(moves[0].move).c_str(), moves[0].value, nodes, seconds, cluster.deaths);
+    return 0;
+}
@@ -0,0 +1,415 @@
+/**
+ * @brief Microbenchmarks for the model and AI hot paths
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ *
+ * Uso: bench [repeticiones] [resultados.jsonl] [configuracion.ini]
+ *
+ * Sin configuracion se usan los valores incorporados, para que los numeros
+ * no dependan del edaversi.ini de cada uno. Cada corrida agrega una linea
+ * JSON al archivo de resultados, con el commit con el que se configuro.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ai.h"
+#include "config.h"
+#include "nnue.h"
+
+#ifndef EDAVERSI_COMMIT
+#define EDAVERSI_COMMIT "desconocido"
+#endif
+
+#ifndef EDAVERSI_BUILD_NAME
+#define EDAVERSI_BUILD_NAME "desconocida"
+#endif
+
+// Posiciones del FFO endgame test suite: tablero de A1 a H8 por filas,
+// X negras, O blancas, el jugador que mueve y la jugada perfecta
+struct BenchPosition
+{
+    const char *name;
+    const char *board;
+    Player player;
+    const char *solution;
+};
+
+static const BenchPosition FFO_POSITIONS[] = {
+    {"ffo01", "--XXXXX--OOOXX-O-OOOXXOX-OXOXOXXOXXXOXXX--XOXOXX-XXXOOO--OOOOO--", PLAYER_BLACK, "G8"},
+    {"ffo02", "-XXXXXX---XOOOO--XOXXOOX-OOOOOOOOOOOXXOOOOOXXOOX--XXOO----XXXXX-", PLAYER_BLACK, "A4"},
+    {"ffo40", "O--OOOOX-OOOOOOXOOXXOOOXOOXOOOXXOOOOOOXX---OOOOX----O--X--------", PLAYER_BLACK, "A2"},
+    {"ffo41", "-OOOOO----OOOOX--OOOOOO-XXXXXOO--XXOOX--OOXOXX----OXXO---OOO--O-", PLAYER_BLACK, "H4"},
+};
+
+// Aperturas conocidas para el libro
+static const char *OPENING_LINES[] = {
+    "",
+    "F5",
+    "F5D6",
+    "C4C3",
+    "C4E3F4C5D6F3",
+    "C4C3D3C5D6F4F5E6C6",
+};
+
+struct BenchResult
+{
+    std::string name;
+    long operations;
+    double nsPerOp;
+};
+
+// Evita que el compilador descarte el trabajo medido
+static volatile long g_sink;
+
+static double benchClock()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static tree_logic parsePosition(BenchPosition const&position)
+{
+    tree_logic state;
+    state.currentPlayer = position.player;
+    state.gameOver = false;
+
+    for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++)
+    {
+        char c = position.board[i];
+        Piece piece = (c == 'X') ? PIECE_BLACK : (c == 'O') ? PIECE_WHITE : PIECE_EMPTY;
+        state.board[i / BOARD_SIZE][i % BOARD_SIZE] = piece;
+    }
+    return state;
+}
+
+static tree_logic playLine(const char *line)
+{
+    tree_logic state;
+    startState(state);
+
+    for (size_t i = 0; i + 1 < strlen(line); i += 2)
+        playMove(state, Square{line[i] - 'A', line[i + 1] - '1'});
+    return state;
+}
+
+static GameModel makeModel(tree_logic const&state)
+{
+    GameModel model;
+    initModel(model);
+    startModel(model);
+    model.tree = state;
+    model.humanPlayer = (state.currentPlayer == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK;
+    return model;
+}
+
+static void addResult(std::vector<BenchResult> &results, const char *name,
+                      long operations, double seconds)
+{
+    BenchResult result = {name, operations, seconds * 1e9 / operations};
+    printf("%-28s %12ld ops %12.1f ns/op\n", name, operations, result.nsPerOp);
+    results.push_back(result);
+}
+
+static void benchValidMoves(std::vector<tree_logic> const&states, int repetitions,
+                            std::vector<BenchResult> &results)
+{
+    Moves moves;
+    long sum = 0, operations = 0;
+    double start = benchClock();
+
+    for (int r = 0; r < repetitions; r++)
+        for (auto const&state : states)
+        {
+            getValidMoves(state, moves);
+            sum += moves.size();
+            operations++;
+        }
+
+    addResult(results, "getValidMoves", operations, benchClock() - start);
+    g_sink = sum;
+}
+
+static void benchPlayMove(std::vector<tree_logic> const&states, int repetitions,
+                          std::vector<BenchResult> &results)
+{
+    std::vector<std::pair<tree_logic, Square>> plays;
+    for (auto const&state : states)
+    {
+        Moves moves;
+        getValidMoves(state, moves);
+        for (auto move : moves)
+            plays.push_back({state, move});
+    }
+
+    long sum = 0, operations = 0;
+    double start = benchClock();
+
+    for (int r = 0; r < repetitions; r++)
+        for (auto const&play : plays)
+        {
+            tree_logic child = play.first;
+            playMove(child, play.second);
+            sum += child.currentPlayer;
+            operations++;
+        }
+
+    addResult(results, "playMove", operations, benchClock() - start);
+    g_sink = sum;
+}
+
+static void benchValueState(std::vector<tree_logic> const&states, int repetitions,
+                            std::vector<BenchResult> &results)
+{
+    EvalWeights weights = getConfig().weights;
+    long sum = 0, operations = 0;
+    double start = benchClock();
+
+    for (int r = 0; r < repetitions; r++)
+        for (auto const&state : states)
+        {
+            tree_logic leaf = state;
+            sum += value_state(leaf, state.currentPlayer, Square{0, 0}, weights);
+            operations++;
+        }
+
+    addResult(results, "value_state", operations, benchClock() - start);
+    g_sink = sum;
+}
+
+// Costo por nodo de la red: actualizar el acumulador con la jugada y evaluar.
+// Los pesos son al azar; el costo no depende de ellos.
+static void benchNnue(std::vector<tree_logic> const&states, int repetitions,
+                      std::vector<BenchResult> &results)
+{
+    std::unique_ptr<NnueNetwork> network(new NnueNetwork);
+    uint32_t seed = 1;
+    int8_t *bytes = (int8_t *)network.get();
+    for (size_t i = 0; i < sizeof(NnueNetwork); i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        bytes[i] = (int8_t)((seed >> 16) % 17) - 8;
+    }
+
+    struct Child
+    {
+        NnueAccumulator parent;
+        Square move;
+        FlipMask flips;
+        Player mover;
+        Player next;
+    };
+    std::vector<Child> children;
+    for (auto const&state : states)
+    {
+        Moves moves;
+        getValidMoves(state, moves);
+        for (auto move : moves)
+        {
+            Child child;
+            resetNnueAccumulator(*network, state, child.parent);
+            tree_logic next = state;
+            UndoStack undo;
+            undo.size = 0;
+            child.move = move;
+            child.mover = state.currentPlayer;
+            child.flips = makeMove(next, move, undo);
+            child.next = next.currentPlayer;
+            children.push_back(child);
+        }
+    }
+
+    long sum = 0, operations = 0;
+    double start = benchClock();
+    for (int r = 0; r < repetitions; r++)
+        for (auto const&child : children)
+        {
+            NnueAccumulator accumulator = child.parent;
+            updateNnueAccumulator(*network, accumulator, child.move, child.flips, child.mover);
+            sum += accumulator.values[0];
+            operations++;
+        }
+    addResult(results, "updateNnueAccumulator", operations, benchClock() - start);
+
+    operations = 0;
+    start = benchClock();
+    for (int r = 0; r < repetitions; r++)
+        for (auto const&child : children)
+        {
+            sum += evaluateNnue(*network, child.parent, child.next);
+            operations++;
+        }
+    addResult(results, isNnueAvx2() ? "evaluateNnue/avx2" : "evaluateNnue/escalar", operations,
+              benchClock() - start);
+    g_sink = sum;
+}
+
+static void benchOpeningBook(int repetitions, std::vector<BenchResult> &results)
+{
+    std::vector<GameModel> models;
+    for (auto line : OPENING_LINES)
+        models.push_back(makeModel(playLine(line)));
+
+    long sum = 0, operations = 0;
+    double start = benchClock();
+
+    for (int r = 0; r < repetitions; r++)
+        for (auto const&model : models)
+        {
+            Square move;
+            sum += openingBookBestMove(model, move);
+            operations++;
+        }
+
+    addResult(results, "openingBookBestMove", operations, benchClock() - start);
+    g_sink = sum;
+}
+
+// Una sola vez por posicion: la tabla de transposicion y la cache de finales
+// harian que las repeticiones no cuesten nada
+static void benchBestMove(std::vector<BenchResult> &results)
+{
+    for (auto const&position : FFO_POSITIONS)
+    {
+        GameModel model = makeModel(parsePosition(position));
+        double start = benchClock();
+        Square move = getBestMove(model);
+        double seconds = benchClock() - start;
+
+        std::string name = std::string("getBestMove/") + position.name;
+        addResult(results, name.c_str(), 1, seconds);
+        printf("%-28s jugada %c%c, perfecta %s\n", "", 'A' + move.x, '1' + move.y,
+               position.solution);
+    }
+}
+
+// Nodos por segundo de la busqueda a profundidad fija, sin libro ni limites:
+// es la medida con la que se comparan las compilaciones con y sin PGO
+static void benchSearch(std::vector<tree_logic> const&states, std::vector<BenchResult> &results)
+{
+    long nodes = 0, probes = 0, hits = 0;
+    double start = benchClock();
+
+    for (auto const&state : states)
+        if (!state.gameOver)
+        {
+            SearchResult result = searchPosition(state, state.currentPlayer, 8, nullptr);
+            nodes += result.nodes;
+            probes += result.evalCacheProbes;
+            hits += result.evalCacheHits;
+        }
+
+    double seconds = benchClock() - start;
+    addResult(results, "searchPosition/node", nodes, seconds);
+    printf("%-28s %12.0f nodos/s, evaluaciones en cache %.1f%%\n", "", nodes / seconds,
+           probes ? 100.0 * hits / probes : 0.0);
+}
+
+// Tiempo de las mismas busquedas con 1, 2, 4... hilos, hasta 16 o los nucleos
+// que haya. Los nodos por segundo no sirven: los hilos repiten parte del
+// arbol. Cada cantidad de hilos empieza con la tabla de transposicion vacia.
+// A profundidad fija se usa Lazy SMP; en fuerza bruta (depth 0), la division
+// de finales.
+static void benchThreads(const char *name, std::vector<tree_logic> const&states, int depth,
+                         std::vector<BenchResult> &results)
+{
+    std::map<std::string, std::string> saved;
+    getConfigValues(getConfig(), saved);
+
+    int maxThreads = std::min(16, std::max(4, (int)std::thread::hardware_concurrency()));
+    double single = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        std::map<std::string, std::string> values = saved;
+        values["search.threads"] = std::to_string(threads);
+        setConfigValues(values, "bench");
+
+        long searches = 0;
+        double start = benchClock();
+        for (auto const&state : states)
+            if (!state.gameOver)
+            {
+                searchPosition(state, state.currentPlayer, depth, nullptr);
+                searches++;
+            }
+        double seconds = benchClock() - start;
+        if (threads == 1)
+            single = seconds;
+
+        std::string result = std::string(name) + "/threads=" + std::to_string(threads);
+        addResult(results, result.c_str(), searches, seconds);
+        printf("%-28s x%.2f\n", "", single / seconds);
+    }
+
+    setConfigValues(saved, "bench");
+}
+
+static bool appendResults(const char *path, std::vector<BenchResult> const&results, int repetitions)
+{
+    FILE *file = fopen(path, "a");
+    if (!file)
+        return false;
+
+    fprintf(file, "{\"commit\": \"%s\", \"build\": \"%s\", \"time\": %ld, \"repetitions\": %d, \"results\": {",
+            EDAVERSI_COMMIT, EDAVERSI_BUILD_NAME, (long)time(nullptr), repetitions);
+    for (size_t i = 0; i < results.size(); i++)
+        fprintf(file, "%s\"%s\": %.1f", (i > 0) ? ", " : "", results[i].name.c_str(), results[i].nsPerOp);
+    fprintf(file, "}}\n");
+
+    return fclose(file) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int repetitions = (argc > 1) ? atoi(argv[1]) : 20000;
+    const char *outputPath = (argc > 2) ? argv[2] : "bench_results.jsonl";
+    if (argc > 3)
+        loadConfig(argv[3]);
+
+    printf("Commit %s, compilacion %s\n", EDAVERSI_COMMIT, EDAVERSI_BUILD_NAME);
+
+    std::vector<tree_logic> states;
+    for (auto const&position : FFO_POSITIONS)
+        states.push_back(parsePosition(position));
+    for (auto line : OPENING_LINES)
+        states.push_back(playLine(line));
+
+    // La primera busqueda carga el libro
+    GameModel warmup = makeModel(playLine(""));
+    getBestMove(warmup);
+
+    std::vector<BenchResult> results;
+    benchValidMoves(states, repetitions, results);
+    benchPlayMove(states, repetitions / 10, results);
+    benchValueState(states, repetitions, results);
+    benchNnue(states, repetitions, results);
+    benchOpeningBook(repetitions, results);
+    benchSearch(states, results);
+    benchBestMove(results);
+    benchThreads("searchPosition", states, 8, results);
+
+    // Finales del FFO que se resuelven en segundos
+    std::vector<tree_logic> endgames;
+    for (auto const&position : FFO_POSITIONS)
+        if (std::count(position.board, position.board + 64, '-') <= 14)
+            endgames.push_back(parsePosition(position));
+    benchThreads("solve", endgames, 0, results);
+
+    if (!appendResults(outputPath, results, repetitions))
+    {
+        printf("No se pudo escribir %s\n", outputPath);
+        return 1;
+    }
+    printf("Resultados agregados a %s\n", outputPath);
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * @brief Builds and updates the binary opening book
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ *
+ * Uso: book_build <libro> [jugadas completas] [jugadas de partidas] [profundidad] [archivo.edb]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "book.h"
+#include "config.h"
+#include "gamedb.h"
+
+static void printProgress(int searched, int total)
+{
+    if (searched % 50 == 0 || searched == total)
+        printf("Buscadas %d/%d posiciones\n", searched, total);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("Uso: %s <libro> [jugadas completas] [jugadas de partidas] [profundidad] [archivo.edb]\n",
+               argv[0]);
+        return 1;
+    }
+
+    loadConfig(CONFIG_DEFAULT_PATH);
+
+    const char *bookPath = argv[1];
+    int fullPlies = (argc > 2) ? atoi(argv[2]) : 4;
+    int gamePlies = (argc > 3) ? atoi(argv[3]) : 12;
+    int depth = (argc > 4) ? atoi(argv[4]) : 6;
+    std::string archivePath = (argc > 5) ? argv[5] : getConfig().archivePath;
+
+    // Si el libro ya existe solo se agregan y buscan las posiciones nuevas
+    BookTree book;
+    initBook(book);
+    if (isBinaryBook(bookPath) && !loadBook(bookPath, book))
+    {
+        printf("No se pudo leer %s\n", bookPath);
+        return 1;
+    }
+    size_t previous = book.entries.size();
+
+    int added = expandBook(book, fullPlies);
+
+    // Las partidas que llegaron al archivo desde la ultima vez
+    int games = 0;
+    GameDatabase db;
+    if (!archivePath.empty() && openGameDatabase(db, archivePath.c_str()))
+    {
+        GameView game;
+        uint64_t cursor = book.archiveOffset;
+        while (nextGame(db, cursor, game))
+        {
+            added += addBookGame(book, game.moves, game.moveCount, gamePlies);
+            games++;
+        }
+        book.archiveOffset = cursor;
+        closeGameDatabase(db);
+    }
+
+    printf("Libro: %zu posiciones, %d nuevas, %d partidas nuevas\n",
+           previous, added, games);
+
+    int searched = searchBook(book, depth, printProgress);
+    propagateBook(book);
+
+    if (!saveBook(bookPath, book))
+    {
+        printf("No se pudo escribir %s\n", bookPath);
+        return 1;
+    }
+
+    // Valor y jugada de la posicion inicial
+    tree_logic start;
+    startState(start);
+    int symmetry;
+    BookEntry const&root = book.entries[canonicalHash(start, symmetry)];
+    Square move = inverseTransformSquare(unpackSquare(root.bestMove), symmetry);
+    printf("Guardado %s: %zu posiciones, %d buscadas a profundidad %d, inicio %c%c (%d)\n",
+           bookPath, book.entries.size(), searched, depth,
+           'A' + move.x, '1' + move.y, root.value);
+    return 0;
+}
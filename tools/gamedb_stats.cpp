@@ -0,0 +1,103 @@
+/**
+ * @brief Prints statistics of a game archive
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ *
+ * Uso: gamedb_stats [archivo] [cantidad de aperturas]
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gamedb.h"
+
+struct OpeningStats
+{
+    uint64_t firstOffset;
+    int games;
+    int blackWins;
+    int whiteWins;
+};
+
+// Jugadas empaquetadas a notacion "C4C3..."
+static std::string movesToString(const uint8_t *moves, int count)
+{
+    std::string s;
+    for (int i = 0; i < count; i++)
+    {
+        Square square = unpackSquare(moves[i]);
+        s.push_back(char('A' + square.x));
+        s.push_back(char('1' + square.y));
+    }
+    return s;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = (argc > 1) ? argv[1] : "partidas.edb";
+    int topOpenings = (argc > 2) ? atoi(argv[2]) : 10;
+
+    GameDatabase db;
+    if (!openGameDatabase(db, path))
+    {
+        printf("No se pudo abrir %s\n", path);
+        return 1;
+    }
+
+    // Recorrido directo sobre el archivo mapeado
+    long games = 0, totalMoves = 0;
+    long results[4] = {0, 0, 0, 0};
+    uint64_t cursor = 0;
+    GameView game;
+
+    while (nextGame(db, cursor, game))
+    {
+        games++;
+        totalMoves += game.moveCount;
+        results[getGameResult(game.discDiff)]++;
+    }
+
+    printf("%s: %ld partidas, %.1f jugadas promedio\n", path, games,
+           games ? (double)totalMoves / games : 0.0);
+    printf("Ganan negras: %ld, ganan blancas: %ld, empates: %ld\n",
+           results[RESULT_BLACK_WIN], results[RESULT_WHITE_WIN], results[RESULT_DRAW]);
+
+    // Aperturas mas jugadas, usando solo el indice
+    std::unordered_map<uint64_t, OpeningStats> openings;
+    for (size_t i = 0; i < db.indexCount; i++)
+    {
+        GameIndexEntry const&entry = db.index[i];
+        OpeningStats &stats = openings[entry.openingKey];
+        if (stats.games == 0)
+            stats.firstOffset = entry.offset;
+        stats.games++;
+        stats.blackWins += (getGameResult(entry.discDiff) == RESULT_BLACK_WIN);
+        stats.whiteWins += (getGameResult(entry.discDiff) == RESULT_WHITE_WIN);
+    }
+
+    std::vector<OpeningStats> sorted;
+    for (auto &kv : openings)
+        sorted.push_back(kv.second);
+    std::sort(sorted.begin(), sorted.end(),
+              [](OpeningStats const&a, OpeningStats const&b) { return a.games > b.games; });
+
+    for (int i = 0; i < topOpenings && i < (int)sorted.size(); i++)
+    {
+        OpeningStats const&stats = sorted[i];
+        if (!getGame(db, stats.firstOffset, game))
+            continue;
+
+        int plies = std::min(game.moveCount, GAMEDB_OPENING_PLIES);
+        printf("%-14s %6d partidas, negras %5.1f%%, blancas %5.1f%%\n",
+               movesToString(game.moves, plies).c_str(), stats.games,
+               100.0 * stats.blackWins / stats.games, 100.0 * stats.whiteWins / stats.games);
+    }
+
+    closeGameDatabase(db);
+    return 0;
+}
@@ -0,0 +1,491 @@
+/**
+ * @brief Trains the neural evaluation of nnue.h on the CPU
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ *
+ * Uso: nnue_train <salida.nnue> [partidas de autojuego] [epocas] [partidas.db]
+ *
+ * Las posiciones salen de partidas de autojuego a profundidad 2 con la
+ * evaluacion de la configuracion (10 jugadas al azar al empezar y un 10% de
+ * jugadas al azar despues) y, si se da, de un archivo de partidas. Cada
+ * posicion se etiqueta con la diferencia final de su partida y se usa en sus
+ * 8 simetrias. La red se entrena en flotante con Adam, se cuantiza y se
+ * juega un match contra la evaluacion lineal a la misma profundidad.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ai.h"
+#include "bitboard.h"
+#include "config.h"
+#include "gamedb.h"
+#include "nnue.h"
+
+#define SELF_PLAY_DEPTH 2
+#define RANDOM_OPENING_PLIES 10
+#define RANDOM_MOVE_PERCENT 10
+#define BATCH_SIZE 256
+#define LEARNING_RATE 0.001f
+#define MATCH_GAMES 40
+#define MATCH_DEPTH 3
+
+// Posicion de entrenamiento: objetivo = diferencia final de negras / 64
+struct Sample
+{
+    uint64_t black;
+    uint64_t white;
+    bool whiteToMove;
+    float target;
+    int game;                   // para separar la validacion por partida
+};
+
+// Red en flotante con las mismas formas que NnueNetwork
+struct FloatNetwork
+{
+    float inputWeights[NNUE_INPUTS][NNUE_HIDDEN1];
+    float inputBias[NNUE_HIDDEN1];
+    float hiddenWeights[NNUE_HIDDEN2][NNUE_HIDDEN1];
+    float hiddenBias[NNUE_HIDDEN2];
+    float outputWeights[NNUE_HIDDEN2];
+    float outputBias;
+};
+
+// Los pesos de las capas densas tienen que entrar en 8 bits
+static const float MAX_DENSE_WEIGHT = 127.0f / NNUE_WEIGHT_SCALE;
+
+static double trainClock()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void addGamePositions(std::vector<Bitboard> const&boards, std::vector<bool> const&whiteToMove,
+                             int discDiff, int game, std::vector<Sample> &samples)
+{
+    for (size_t i = 0; i < boards.size(); i++)
+        for (int symmetry = 0; symmetry < SYMMETRY_COUNT; symmetry++)
+            samples.push_back(Sample{transformBits(boards[i].black, symmetry),
+                                     transformBits(boards[i].white, symmetry),
+                                     whiteToMove[i], discDiff / 64.0f, game});
+}
+
+static void playSelfGames(int games, std::mt19937 &random, std::vector<Sample> &samples)
+{
+    double start = trainClock();
+
+    for (int game = 0; game < games; game++)
+    {
+        tree_logic state;
+        startState(state);
+        std::vector<Bitboard> boards;
+        std::vector<bool> whiteToMove;
+
+        for (int ply = 0; !state.gameOver; ply++)
+        {
+            Moves moves;
+            getValidMoves(state, moves);
+
+            Square move = moves[random() % moves.size()];
+            if (ply >= RANDOM_OPENING_PLIES)
+            {
+                boards.push_back(getBitboard(state));
+                whiteToMove.push_back(state.currentPlayer == PLAYER_WHITE);
+                if ((int)(random() % 100) >= RANDOM_MOVE_PERCENT)
+                    move = searchPosition(state, state.currentPlayer, SELF_PLAY_DEPTH, nullptr).bestMove;
+            }
+            playMove(state, move);
+        }
+
+        int discDiff = getScore(state, PLAYER_BLACK) - getScore(state, PLAYER_WHITE);
+        addGamePositions(boards, whiteToMove, discDiff, game, samples);
+
+        if ((game + 1) % 500 == 0)
+            printf("%d partidas de autojuego (%.0f s)\n", game + 1, trainClock() - start);
+    }
+}
+
+static int readDatabaseGames(const char *path, int firstGame, std::vector<Sample> &samples)
+{
+    GameDatabase db;
+    if (!openGameDatabase(db, path))
+        return 0;
+
+    uint64_t cursor = 0;
+    GameView view;
+    int games = 0;
+    while (nextGame(db, cursor, view))
+    {
+        Bitboard board;
+        Player player = PLAYER_BLACK;
+        tree_logic start;
+        startState(start);
+        board = getBitboard(start);
+
+        std::vector<Bitboard> boards;
+        std::vector<bool> whiteToMove;
+        bool valid = true;
+        for (int i = 0; i < view.moveCount && valid; i++)
+        {
+            if (i >= RANDOM_OPENING_PLIES)
+            {
+                boards.push_back(board);
+                whiteToMove.push_back(player == PLAYER_WHITE);
+            }
+            valid = playBitboardMove(board, player, view.moves[i]);
+        }
+
+        if (valid)
+            addGamePositions(boards, whiteToMove, view.discDiff, firstGame + games++, samples);
+    }
+
+    closeGameDatabase(db);
+    return games;
+}
+
+static void initFloatNetwork(FloatNetwork &network, std::mt19937 &random)
+{
+    std::uniform_real_distribution<float> input(-0.1f, 0.1f);
+    std::uniform_real_distribution<float> hidden(-0.3f, 0.3f);
+
+    for (auto &row : network.inputWeights)
+        for (auto &w : row)
+            w = input(random);
+    for (auto &b : network.inputBias)
+        b = 0.5f;
+    for (auto &row : network.hiddenWeights)
+        for (auto &w : row)
+            w = hidden(random);
+    for (auto &b : network.hiddenBias)
+        b = 0.1f;
+    for (auto &w : network.outputWeights)
+        w = hidden(random);
+    network.outputBias = 0;
+}
+
+static int getActiveInputs(Sample const&sample, int *inputs)
+{
+    int count = 0;
+    for (uint64_t bits = sample.black; bits; bits &= bits - 1)
+        inputs[count++] = __builtin_ctzll(bits);
+    for (uint64_t bits = sample.white; bits; bits &= bits - 1)
+        inputs[count++] = NNUE_SQUARES + __builtin_ctzll(bits);
+    if (sample.whiteToMove)
+        inputs[count++] = NNUE_WHITE_TO_MOVE;
+    return count;
+}
+
+struct Activations
+{
+    int inputs[NNUE_INPUTS];
+    int inputCount;
+    float hidden1[NNUE_HIDDEN1];    // antes de recortar
+    float clipped1[NNUE_HIDDEN1];
+    float hidden2[NNUE_HIDDEN2];
+    float output;
+};
+
+static float clip(float x)
+{
+    return std::min(std::max(x, 0.0f), 1.0f);
+}
+
+static void forward(FloatNetwork const&network, Sample const&sample, Activations &a)
+{
+    a.inputCount = getActiveInputs(sample, a.inputs);
+
+    for (int i = 0; i < NNUE_HIDDEN1; i++)
+        a.hidden1[i] = network.inputBias[i];
+    for (int k = 0; k < a.inputCount; k++)
+        for (int i = 0; i < NNUE_HIDDEN1; i++)
+            a.hidden1[i] += network.inputWeights[a.inputs[k]][i];
+    for (int i = 0; i < NNUE_HIDDEN1; i++)
+        a.clipped1[i] = clip(a.hidden1[i]);
+
+    a.output = network.outputBias;
+    for (int j = 0; j < NNUE_HIDDEN2; j++)
+    {
+        float sum = network.hiddenBias[j];
+        for (int i = 0; i < NNUE_HIDDEN1; i++)
+            sum += network.hiddenWeights[j][i] * a.clipped1[i];
+        a.hidden2[j] = sum;
+        a.output += network.outputWeights[j] * clip(sum);
+    }
+}
+
+// Acumula el gradiente del error cuadratico de una muestra
+static void backward(FloatNetwork const&network, Activations const&a, float target, FloatNetwork &gradient)
+{
+    float error = 2 * (a.output - target);
+    float hidden1Error[NNUE_HIDDEN1] = {};
+
+    gradient.outputBias += error;
+    for (int j = 0; j < NNUE_HIDDEN2; j++)
+    {
+        gradient.outputWeights[j] += error * clip(a.hidden2[j]);
+        if (a.hidden2[j] <= 0 || a.hidden2[j] >= 1)
+            continue;
+
+        float hiddenError = error * network.outputWeights[j];
+        gradient.hiddenBias[j] += hiddenError;
+        for (int i = 0; i < NNUE_HIDDEN1; i++)
+        {
+            gradient.hiddenWeights[j][i] += hiddenError * a.clipped1[i];
+            hidden1Error[i] += hiddenError * network.hiddenWeights[j][i];
+        }
+    }
+
+    for (int i = 0; i < NNUE_HIDDEN1; i++)
+        if (a.hidden1[i] <= 0 || a.hidden1[i] >= 1)
+            hidden1Error[i] = 0;
+
+    for (int i = 0; i < NNUE_HIDDEN1; i++)
+        gradient.inputBias[i] += hidden1Error[i];
+    for (int k = 0; k < a.inputCount; k++)
+        for (int i = 0; i < NNUE_HIDDEN1; i++)
+            gradient.inputWeights[a.inputs[k]][i] += hidden1Error[i];
+}
+
+// Adam sobre la red vista como un arreglo de flotantes
+struct Adam
+{
+    std::vector<float> m;
+    std::vector<float> v;
+    int steps;
+};
+
+static void adamStep(Adam &adam, FloatNetwork &network, FloatNetwork const&gradient, float scale)
+{
+    const float beta1 = 0.9f, beta2 = 0.999f, epsilon = 1e-8f;
+    float *weights = (float *)&network;
+    float const*grads = (float const*)&gradient;
+    size_t count = sizeof(FloatNetwork) / sizeof(float);
+
+    adam.steps++;
+    float correction1 = 1 - std::pow(beta1, (float)adam.steps);
+    float correction2 = 1 - std::pow(beta2, (float)adam.steps);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        float g = grads[i] * scale;
+        adam.m[i] = beta1 * adam.m[i] + (1 - beta1) * g;
+        adam.v[i] = beta2 * adam.v[i] + (1 - beta2) * g * g;
+        weights[i] -= LEARNING_RATE * (adam.m[i] / correction1) / (std::sqrt(adam.v[i] / correction2) + epsilon);
+    }
+
+    for (auto &row : network.hiddenWeights)
+        for (auto &w : row)
+            w = std::min(std::max(w, -MAX_DENSE_WEIGHT), MAX_DENSE_WEIGHT);
+    for (auto &w : network.outputWeights)
+        w = std::min(std::max(w, -MAX_DENSE_WEIGHT), MAX_DENSE_WEIGHT);
+}
+
+// Error medio en fichas de la red flotante
+static double floatError(FloatNetwork const&network, std::vector<Sample> const&samples)
+{
+    double sum = 0;
+    Activations a;
+    for (auto const&sample : samples)
+    {
+        forward(network, sample, a);
+        sum += std::fabs(a.output - sample.target) * 64;
+    }
+    return samples.empty() ? 0 : sum / samples.size();
+}
+
+template <typename T>
+static T quantize(float value, float scale, T low, T high)
+{
+    long rounded = std::lround(value * scale);
+    return (T)std::min(std::max(rounded, (long)low), (long)high);
+}
+
+static void quantizeNetwork(FloatNetwork const&network, NnueNetwork &quantized)
+{
+    for (int f = 0; f < NNUE_INPUTS; f++)
+        for (int i = 0; i < NNUE_HIDDEN1; i++)
+            quantized.inputWeights[f][i] = quantize<int16_t>(network.inputWeights[f][i],
+                                                             NNUE_ACTIVATION_SCALE, -32767, 32767);
+    for (int i = 0; i < NNUE_HIDDEN1; i++)
+        quantized.inputBias[i] = quantize<int16_t>(network.inputBias[i], NNUE_ACTIVATION_SCALE, -32767, 32767);
+
+    for (int j = 0; j < NNUE_HIDDEN2; j++)
+    {
+        for (int i = 0; i < NNUE_HIDDEN1; i++)
+            quantized.hiddenWeights[j][i] = quantize<int8_t>(network.hiddenWeights[j][i],
+                                                             NNUE_WEIGHT_SCALE, -127, 127);
+        quantized.hiddenBias[j] = quantize<int32_t>(network.hiddenBias[j],
+                                                    NNUE_ACTIVATION_SCALE * NNUE_WEIGHT_SCALE,
+                                                    INT32_MIN, INT32_MAX);
+        quantized.outputWeights[j] = quantize<int8_t>(network.outputWeights[j], NNUE_WEIGHT_SCALE, -127, 127);
+    }
+    quantized.outputBias = quantize<int32_t>(network.outputBias, NNUE_ACTIVATION_SCALE * NNUE_WEIGHT_SCALE,
+                                             INT32_MIN, INT32_MAX);
+}
+
+// Error medio en fichas de la red cuantizada, evaluada como en la busqueda
+static double quantizedError(NnueNetwork const&network, std::vector<Sample> const&samples)
+{
+    double sum = 0;
+    for (auto const&sample : samples)
+    {
+        Player player = sample.whiteToMove ? PLAYER_WHITE : PLAYER_BLACK;
+        tree_logic state = getTreeLogic(Bitboard{sample.black, sample.white}, player);
+        NnueAccumulator accumulator;
+        resetNnueAccumulator(network, state, accumulator);
+        double value = evaluateNnue(network, accumulator, player) / (double)FINAL_DISC_VALUE;
+        sum += std::fabs(value - sample.target * 64);
+    }
+    return samples.empty() ? 0 : sum / samples.size();
+}
+
+static void train(FloatNetwork &network, std::vector<Sample> &training, std::vector<Sample> const&validation,
+                  int epochs, std::mt19937 &random)
+{
+    Adam adam;
+    adam.m.assign(sizeof(FloatNetwork) / sizeof(float), 0);
+    adam.v.assign(sizeof(FloatNetwork) / sizeof(float), 0);
+    adam.steps = 0;
+
+    std::unique_ptr<FloatNetwork> gradient(new FloatNetwork);
+    Activations a;
+
+    for (int epoch = 0; epoch < epochs; epoch++)
+    {
+        double start = trainClock();
+        std::shuffle(training.begin(), training.end(), random);
+
+        for (size_t first = 0; first < training.size(); first += BATCH_SIZE)
+        {
+            size_t last = std::min(first + BATCH_SIZE, training.size());
+            memset(gradient.get(), 0, sizeof(FloatNetwork));
+            for (size_t i = first; i < last; i++)
+            {
+                forward(network, training[i], a);
+                backward(network, a, training[i].target, *gradient);
+            }
+            adamStep(adam, network, *gradient, 1.0f / (last - first));
+        }
+
+        printf("Epoca %d: error de validacion %.2f fichas (%.0f s)\n", epoch + 1,
+               floatError(network, validation), trainClock() - start);
+    }
+}
+
+static void setNnueFile(std::map<std::string, std::string> values, std::string const&path)
+{
+    values["eval.nnue_file"] = path;
+    setConfigValues(values, "nnue_train");
+}
+
+// Match a profundidad fija desde aperturas al azar, cada una con los dos
+// colores. Devuelve los puntos de la red (1 por victoria, 0.5 por empate).
+static double playMatch(const char *path, std::mt19937 &random)
+{
+    std::map<std::string, std::string> values;
+    getConfigValues(getConfig(), values);
+    values["endgame.cache_mb"] = "0";
+
+    double points = 0;
+    long nodes[2] = {0, 0};
+    double seconds[2] = {0, 0};
+    tree_logic opening;
+
+    for (int game = 0; game < MATCH_GAMES; game++)
+    {
+        if (game % 2 == 0)
+        {
+            startState(opening);
+            for (int ply = 0; ply < 8 && !opening.gameOver; ply++)
+            {
+                Moves moves;
+                getValidMoves(opening, moves);
+                playMove(opening, moves[random() % moves.size()]);
+            }
+        }
+
+        Player nnuePlayer = (game % 2 == 0) ? PLAYER_BLACK : PLAYER_WHITE;
+        tree_logic state = opening;
+        while (!state.gameOver)
+        {
+            int side = (state.currentPlayer == nnuePlayer) ? 1 : 0;
+            setNnueFile(values, side ? path : "");
+
+            double start = trainClock();
+            SearchResult result = searchPosition(state, state.currentPlayer, MATCH_DEPTH, nullptr);
+            seconds[side] += trainClock() - start;
+            nodes[side] += result.nodes;
+            playMove(state, result.bestMove);
+        }
+
+        int own = getScore(state, nnuePlayer);
+        int other = getScore(state, (nnuePlayer == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK);
+        points += (own > other) ? 1 : (own == other) ? 0.5 : 0;
+    }
+
+    setNnueFile(values, "");
+    printf("Red contra evaluacion lineal a profundidad %d: %.1f de %d\n", MATCH_DEPTH, points, MATCH_GAMES);
+    printf("Nodos/s: red %.0f, lineal %.0f\n", nodes[1] / seconds[1], nodes[0] / seconds[0]);
+    return points;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("Uso: %s <salida.nnue> [partidas de autojuego] [epocas] [partidas.db]\n", argv[0]);
+        return 1;
+    }
+
+    const char *outputPath = argv[1];
+    int selfGames = (argc > 2) ? atoi(argv[2]) : 3000;
+    int epochs = (argc > 3) ? atoi(argv[3]) : 10;
+
+    loadConfig(CONFIG_DEFAULT_PATH);
+    printf("Inferencia %s\n", isNnueAvx2() ? "AVX2" : "escalar");
+
+    std::mt19937 random(1);
+    std::vector<Sample> samples;
+    playSelfGames(selfGames, random, samples);
+    if (argc > 4)
+        printf("%d partidas de %s\n", readDatabaseGames(argv[4], selfGames, samples), argv[4]);
+
+    // Una de cada 20 partidas queda para validar
+    std::vector<Sample> training, validation;
+    for (auto const&sample : samples)
+        (sample.game % 20 == 0 ? validation : training).push_back(sample);
+    samples.clear();
+    samples.shrink_to_fit();
+    printf("%zu posiciones de entrenamiento, %zu de validacion\n", training.size(), validation.size());
+    if (training.empty())
+        return 1;
+
+    std::unique_ptr<FloatNetwork> network(new FloatNetwork);
+    initFloatNetwork(*network, random);
+    train(*network, training, validation, epochs, random);
+
+    std::unique_ptr<NnueNetwork> quantized(new NnueNetwork);
+    quantizeNetwork(*network, *quantized);
+    printf("Error de validacion cuantizada: %.2f fichas\n", quantizedError(*quantized, validation));
+
+    if (!saveNnue(outputPath, *quantized))
+    {
+        printf("No se pudo escribir %s\n", outputPath);
+        return 1;
+    }
+    printf("Red guardada en %s\n", outputPath);
+
+    playMatch(outputPath, random);
+    return 0;
+}
@@ -0,0 +1,55 @@
+#!/bin/sh
+#
+# Compilacion con PGO y LTO, y comparacion contra la release comun
+#
+# Uso: tools/pgo.sh [argumentos extra para cmake]
+#
+# 1. Compila la release y corre bench.
+# 2. Compila el motor instrumentado y lo entrena con bench y autojuego.
+# 3. Recompila con los perfiles y LTO, corre bench y reporta la ganancia
+#    en nodos por segundo de searchPosition.
+
+set -e
+
+cd "$(dirname "$0")/.."
+
+JOBS=${JOBS:-$(nproc 2>/dev/null || echo 4)}
+REPETITIONS=${REPETITIONS:-20000}
+RESULTS=build/pgo-results.jsonl
+PROFILE_DIR=build/pgo-data
+
+mkdir -p build
+rm -f "$RESULTS"
+
+echo "== Release"
+cmake --preset release "$@"
+cmake --build --preset release -j "$JOBS"
+build/release/bench "$REPETITIONS" "$RESULTS"
+
+echo "== Entrenamiento"
+rm -rf "$PROFILE_DIR"
+cmake --preset pgo-generate "$@"
+cmake --build --preset pgo-generate -j "$JOBS"
+build/pgo/bench "$REPETITIONS" /dev/null
+build/pgo/probcut_calibrate 4 5 /dev/null
+
+# Clang deja .profraw que hay que unir; GCC usa los .gcda directamente
+if ls "$PROFILE_DIR"/*.profraw >/dev/null 2>&1; then
+    llvm-profdata merge -output="$PROFILE_DIR/default.profdata" "$PROFILE_DIR"/*.profraw
+fi
+
+echo "== PGO + LTO"
+cmake --preset pgo-use "$@"
+cmake --build --preset pgo-use -j "$JOBS"
+build/pgo/bench "$REPETITIONS" "$RESULTS"
+
+# Ganancia en nodos por segundo: ns por nodo de la release sobre el de PGO
+tail -n 2 "$RESULTS" | sed -n 's/.*"searchPosition\/node": \([0-9.]*\).*/\1/p' | {
+    read -r release
+    read -r optimized
+    awk -v a="$release" -v b="$optimized" 'BEGIN {
+        printf "Release: %.0f nodos/s\n", 1e9 / a
+        printf "PGO + LTO: %.0f nodos/s\n", 1e9 / b
+        printf "Ganancia: %+.1f%%\n", (a / b - 1) * 100
+    }'
+}
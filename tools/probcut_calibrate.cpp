@@ -0,0 +1,161 @@
+/**
+ * @brief Calibrates the Multi-ProbCut parameters from self-play positions
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ *
+ * Uso: probcut_calibrate [partidas] [altura maxima] [archivo de salida]
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ai.h"
+#include "config.h"
+#include "probcut.h"
+
+// Muestras (busqueda corta, busqueda profunda) para una etapa y una altura
+struct Samples
+{
+    std::vector<double> shallow;
+    std::vector<double> deep;
+};
+
+// Ajuste por cuadrados minimos de deep = a * shallow + b
+static ProbCutPair fitPair(Samples const&samples, int shallowDepth)
+{
+    ProbCutPair pair;
+    pair.valid = false;
+    pair.shallowDepth = shallowDepth;
+    pair.a = 1;
+    pair.b = 0;
+    pair.sigma = 0;
+
+    size_t n = samples.shallow.size();
+    if (n < 10)
+        return pair;
+
+    double meanX = 0, meanY = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        meanX += samples.shallow[i];
+        meanY += samples.deep[i];
+    }
+    meanX /= n;
+    meanY /= n;
+
+    double covariance = 0, variance = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        covariance += (samples.shallow[i] - meanX) * (samples.deep[i] - meanY);
+        variance += (samples.shallow[i] - meanX) * (samples.shallow[i] - meanX);
+    }
+    if (variance == 0)
+        return pair;
+
+    pair.a = covariance / variance;
+    pair.b = meanY - pair.a * meanX;
+
+    double residuals = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        double error = samples.deep[i] - (pair.a * samples.shallow[i] + pair.b);
+        residuals += error * error;
+    }
+    pair.sigma = std::sqrt(residuals / n);
+    pair.valid = (pair.a > 0);
+    return pair;
+}
+
+int main(int argc, char *argv[])
+{
+    int games = (argc > 1) ? atoi(argv[1]) : 40;
+    int maxHeight = (argc > 2) ? atoi(argv[2]) : 7;
+    const char *outputPath = (argc > 3) ? argv[3] : "probcut.ini";
+
+    if (maxHeight > PROBCUT_MAX_HEIGHT)
+        maxHeight = PROBCUT_MAX_HEIGHT;
+
+    loadConfig(CONFIG_DEFAULT_PATH);
+    AIConfig const&config = getConfig();
+    srand(1);
+
+    static Samples samples[STAGE_COUNT][PROBCUT_MAX_HEIGHT + 1];
+    int positions = 0;
+
+    for (int game = 0; game < games; game++)
+    {
+        tree_logic state;
+        startState(state);
+
+        while (!state.gameOver)
+        {
+            int empties = BOARD_SIZE * BOARD_SIZE -
+                          (getScore(state, PLAYER_BLACK) + getScore(state, PLAYER_WHITE));
+            GameStage stage = getGameStage(config, empties);
+
+            // Una de cada tres posiciones del medio juego, desde el punto de
+            // vista de cualquiera de los dos jugadores
+            if (stage != STAGE_ENDGAME && (rand() % 3) == 0)
+            {
+                Player player = (rand() % 2) ? PLAYER_WHITE : PLAYER_BLACK;
+
+                for (int height = PROBCUT_MIN_HEIGHT; height <= maxHeight; height++)
+                {
+                    // Cada busqueda con la tabla vacia: la corta no puede
+                    // leer los valores que dejo la profunda
+                    int shallowDepth = getProbCutShallowDepth(height);
+                    clearSearchTable();
+                    SearchResult deep = searchPosition(state, player, height, nullptr);
+                    clearSearchTable();
+                    SearchResult shallow = searchPosition(state, player, shallowDepth, nullptr);
+
+                    // Un final encontrado vale FINAL_DISC_VALUE por ficha: son
+                    // pocos y, sin descartarlos, dominan la regresion
+                    if (std::abs(deep.value) >= FINAL_DISC_VALUE ||
+                        std::abs(shallow.value) >= FINAL_DISC_VALUE)
+                        continue;
+
+                    samples[stage][height].shallow.push_back(shallow.value);
+                    samples[stage][height].deep.push_back(deep.value);
+                }
+                positions++;
+            }
+
+            // Partidas variadas: jugadas al azar al principio y de vez en
+            // cuando, si no la mejor jugada a profundidad 2
+            Moves moves;
+            getValidMoves(state, moves);
+            Square move = moves[rand() % moves.size()];
+            if (empties < BOARD_SIZE * BOARD_SIZE - 10 && (rand() % 4) != 0)
+                move = searchPosition(state, state.currentPlayer, 2, nullptr).bestMove;
+            playMove(state, move);
+        }
+
+        printf("Partida %d/%d, %d posiciones\n", game + 1, games, positions);
+    }
+
+    ProbCutTable table;
+    initProbCutTable(table);
+
+    for (int stage = 0; stage < STAGE_COUNT; stage++)
+        for (int height = PROBCUT_MIN_HEIGHT; height <= maxHeight; height++)
+        {
+            ProbCutPair pair = fitPair(samples[stage][height], getProbCutShallowDepth(height));
+            table.pairs[stage][height] = pair;
+            if (pair.valid)
+                printf("%s altura %d: corta %d, a = %.3f, b = %.2f, sigma = %.2f (%zu muestras)\n",
+                       getStageName((GameStage)stage), height, pair.shallowDepth,
+                       pair.a, pair.b, pair.sigma, samples[stage][height].shallow.size());
+        }
+
+    if (!saveProbCutTable(outputPath, table))
+    {
+        printf("No se pudo escribir %s\n", outputPath);
+        return 1;
+    }
+    printf("Parametros guardados en %s\n", outputPath);
+    return 0;
+}
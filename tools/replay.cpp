@@ -0,0 +1,152 @@
+/**
+ * @brief Reruns a log of AI decisions and reports changes of choice or speed
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ *
+ * Uso: replay <decisiones.log> [tolerancia de tiempo en %]
+ *
+ * El registro se graba jugando con record.path en la configuracion. Cada
+ * decision se repite sin ventana, con la configuracion con la que se tomo,
+ * la tabla de transposicion vacia y sin cache de finales, igual que al grabar.
+ * Una jugada, valor o cantidad de nodos distinta es un cambio. El tiempo de
+ * cada decision se informa si sale de la tolerancia; termina con 1 si hubo
+ * algun cambio o si el tiempo total es mas lento que la tolerancia.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "config.h"
+#include "replay.h"
+#include "transposition.h"
+
+static double replayClock()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool applyRecordedConfig(DecisionLog const&log, int id)
+{
+    auto found = log.configs.find(id);
+    if (found == log.configs.end())
+        return false;
+
+    // Lo que se graba no se vuelve a grabar, y las busquedas grabadas no
+    // usaban la cache de finales
+    std::map<std::string, std::string> values = found->second;
+    values["record.path"] = "";
+    values["endgame.cache_mb"] = "0";
+    values["archive.path"] = "";
+
+    setConfigValues(values, "configuracion grabada");
+    prepareSharedSearch();
+    return true;
+}
+
+static std::string formatSquare(Square square)
+{
+    if (!isSquareValid(square))
+        return "--";
+    return std::string(1, (char)('A' + square.x)) + (char)('1' + square.y);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("Uso: %s <decisiones.log> [tolerancia de tiempo en %%]\n", argv[0]);
+        return 1;
+    }
+
+    double tolerance = (argc > 2) ? atof(argv[2]) : 20;
+
+    DecisionLog log;
+    if (!readDecisionLog(argv[1], log))
+    {
+        printf("No se pudo leer %s\n", argv[1]);
+        return 1;
+    }
+
+    int loadedConfig = -1;
+    TranspositionTable tt;
+    int changes = 0, slower = 0, faster = 0, skipped = 0;
+    double recordedSeconds = 0, replayedSeconds = 0;
+
+    for (size_t i = 0; i < log.decisions.size(); i++)
+    {
+        DecisionRecord const&record = log.decisions[i];
+
+        if (record.config != loadedConfig)
+        {
+            if (!applyRecordedConfig(log, record.config))
+            {
+                printf("Decision %zu: falta la configuracion %d\n", i + 1, record.config);
+                return 1;
+            }
+            loadedConfig = record.config;
+            initTranspositionTable(tt, getConfig().ttSizeMB, getConfig().ttHugePages);
+        }
+
+        GameModel model;
+        initModel(model);
+        model.tree = record.state;
+        model.humanPlayer = (record.aiPlayer == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK;
+
+        clearTranspositionTable(tt);
+        double start = replayClock();
+        SearchResult result = getGameBestMove(model, tt, record.remainingTime);
+        double seconds = replayClock() - start;
+
+        std::string recordedMove = formatSquare(record.result.bestMove);
+        std::string replayedMove = formatSquare(result.bestMove);
+
+        // Con el tiempo agotado los nodos dependen de la maquina
+        if (record.result.outOfTime || result.outOfTime)
+        {
+            skipped++;
+            if (recordedMove != replayedMove)
+                printf("Decision %zu: %s -> %s (cortada por tiempo)\n", i + 1,
+                       recordedMove.c_str(), replayedMove.c_str());
+            continue;
+        }
+
+        if (recordedMove != replayedMove || record.result.value != result.value ||
+            record.result.nodes != result.nodes)
+        {
+            printf("Decision %zu: jugada %s -> %s, valor %d -> %d, nodos %d -> %d\n", i + 1,
+                   recordedMove.c_str(), replayedMove.c_str(), record.result.value, result.value,
+                   record.result.nodes, result.nodes);
+            changes++;
+        }
+
+        // Los tiempos muy cortos son puro ruido
+        recordedSeconds += record.seconds;
+        replayedSeconds += seconds;
+        if (record.book || record.seconds < 0.05)
+            continue;
+
+        double change = (seconds / record.seconds - 1) * 100;
+        if (change > tolerance)
+        {
+            printf("Decision %zu: %.3f s -> %.3f s (%+.0f%%)\n", i + 1, record.seconds, seconds, change);
+            slower++;
+        }
+        else if (change < -tolerance)
+            faster++;
+    }
+
+    printf("%zu decisiones: %d cambios, %d mas lentas y %d mas rapidas que %.0f%%, %d cortadas por tiempo\n",
+           log.decisions.size(), changes, slower, faster, tolerance, skipped);
+
+    double total = 0;
+    if (recordedSeconds > 0)
+    {
+        total = (replayedSeconds / recordedSeconds - 1) * 100;
+        printf("Tiempo total: %.2f s grabado, %.2f s ahora (%+.1f%%)\n", recordedSeconds, replayedSeconds, total);
+    }
+
+    return (changes > 0 || total > tolerance) ? 1 : 0;
+}
@@ -0,0 +1,165 @@
+/**
+ * @brief Text front end for many concurrent games against the AI
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ *
+ * Uso: server [configuracion.ini]
+ *
+ * Lee un comando por linea de la entrada estandar y responde una linea por
+ * evento en la salida estandar. Para un socket local alcanza con socat:
+ *   socat UNIX-LISTEN:/tmp/edaversi.sock,fork EXEC:./server
+ *
+ *   nueva <negras|blancas> [segundos]   -> partida <id>   (color del rival de la IA)
+ *   jugar <id> <casilla>                -> ok <id>
+ *   tablero <id>                        -> tablero <id> <64 casillas X/O/-> <turno> <pensando>
+ *   cerrar <id>                         -> cerrada <id>
+ *   estado                              -> estado <partidas> <en cola> <buscando> <jugadas>
+ *   salir
+ *
+ * Las jugadas de la IA llegan cuando terminan: "jugada <id> <casilla> <valor>
+ * <nodos>", y "fin <id> <negras> <blancas>" al terminar la partida.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "config.h"
+#include "session.h"
+
+static std::string formatSquare(Square square)
+{
+    std::string text;
+    text += (char)('A' + square.x);
+    text += (char)('1' + square.y);
+    return text;
+}
+
+static bool parseSquare(const char *text, Square &square)
+{
+    if (strlen(text) != 2)
+        return false;
+
+    square.x = toupper(text[0]) - 'A';
+    square.y = text[1] - '1';
+    return isSquareValid(square);
+}
+
+static void printGameOver(GameModel const&model, int id)
+{
+    printf("fin %d %d %d\n", id, getScore(model.tree, PLAYER_BLACK), getScore(model.tree, PLAYER_WHITE));
+}
+
+static void onAIMove(GameSession const&session, Square move, SearchResult const&result)
+{
+    printf("jugada %d %s %d %d\n", session.id, formatSquare(move).c_str(), result.value, result.nodes);
+    if (session.model.tree.gameOver)
+        printGameOver(session.model, session.id);
+}
+
+static void printBoard(SessionManager &manager, int id)
+{
+    GameModel model;
+    bool pending;
+    if (!getSessionState(manager, id, model, pending))
+    {
+        printf("error %d partida desconocida\n", id);
+        return;
+    }
+
+    std::string board;
+    for (int y = 0; y < BOARD_SIZE; y++)
+        for (int x = 0; x < BOARD_SIZE; x++)
+        {
+            Piece piece = model.tree.board[y][x];
+            board += (piece == PIECE_BLACK) ? 'X' : (piece == PIECE_WHITE) ? 'O' : '-';
+        }
+
+    const char *turn = model.tree.gameOver ? "fin" :
+                       (model.tree.currentPlayer == PLAYER_BLACK) ? "negras" : "blancas";
+    printf("tablero %d %s %s %d\n", id, board.c_str(), turn, pending);
+}
+
+int main(int argc, char *argv[])
+{
+    loadConfig((argc > 1) ? argv[1] : CONFIG_DEFAULT_PATH);
+    AIConfig const&config = getConfig();
+
+    // Una linea por respuesta aunque la salida sea un pipe
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    SessionManager manager;
+    startSessionManager(manager, config.serverWorkers, onAIMove);
+
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        char command[16], argument[16];
+        int id;
+        double seconds;
+
+        if (sscanf(line.c_str(), "%15s", command) != 1)
+            continue;
+
+        if (!strcmp(command, "nueva"))
+        {
+            int fields = sscanf(line.c_str(), "%*s %15s %lf", argument, &seconds);
+            if (fields < 1 || (strcmp(argument, "negras") && strcmp(argument, "blancas")))
+            {
+                printf("error uso: nueva <negras|blancas> [segundos]\n");
+                continue;
+            }
+            if (fields < 2)
+                seconds = config.serverTimeBudget;
+
+            // La respuesta sale antes de encolar la primera jugada de la IA
+            Player human = strcmp(argument, "negras") ? PLAYER_WHITE : PLAYER_BLACK;
+            id = openSession(manager, human, seconds);
+            printf("partida %d\n", id);
+            queueSessionReply(manager, id);
+        }
+        else if (!strcmp(command, "jugar"))
+        {
+            Square move;
+            bool gameOver;
+            if (sscanf(line.c_str(), "%*s %d %15s", &id, argument) != 2 || !parseSquare(argument, move))
+                printf("error uso: jugar <id> <casilla>\n");
+            else if (!playSessionMove(manager, id, move, gameOver))
+                printf("error %d jugada no valida\n", id);
+            else
+            {
+                printf("ok %d\n", id);
+
+                GameModel model;
+                bool pending;
+                if (gameOver && getSessionState(manager, id, model, pending))
+                    printGameOver(model, id);
+                queueSessionReply(manager, id);
+            }
+        }
+        else if (!strcmp(command, "tablero") && sscanf(line.c_str(), "%*s %d", &id) == 1)
+            printBoard(manager, id);
+        else if (!strcmp(command, "cerrar") && sscanf(line.c_str(), "%*s %d", &id) == 1)
+        {
+            if (closeSession(manager, id))
+                printf("cerrada %d\n", id);
+            else
+                printf("error %d partida desconocida\n", id);
+        }
+        else if (!strcmp(command, "estado"))
+        {
+            SessionStats stats = getSessionStats(manager);
+            printf("estado %d %d %d %ld\n", stats.games, stats.queued, stats.searching, stats.searches);
+        }
+        else if (!strcmp(command, "salir"))
+            break;
+        else
+            printf("error comando desconocido: %s\n", command);
+    }
+
+    stopSessionManager(manager);
+    return 0;
+}
@@ -0,0 +1,366 @@
+/**
+ * @brief Solves the 4x4 variant, and 6x6 openings, into a perfect-play database
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ *
+ * Uso: small_solve <tamaño> <salida.db> [casillas minimas] [hilos] [jugadas]
+ *
+ * Primero compara las reglas del motor de variantes en 8x8 con las de
+ * model.cpp sobre partidas al azar. Despues recorre hacia adelante todas las
+ * posiciones alcanzables desde la inicial (o desde las jugadas, por ejemplo
+ * C2D4) reducidas por simetria, una capa por cantidad de casillas vacias,
+ * hasta las casillas minimas. La capa mas baja se resuelve con la busqueda
+ * exacta de variant.h y las demas hacia atras, de abajo hacia arriba, con el
+ * valor de los hijos de la capa de abajo. Al final verifica la base contra la
+ * busqueda exacta en partidas al azar.
+ *
+ * 4x4 se resuelve entero. En 6x6 las capas de en medio tienen del orden de
+ * 10^12 posiciones y no entran en memoria: solo se resuelve el subarbol de
+ * una apertura, que es obligatoria.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ai.h"
+#include "config.h"
+#include "smalldb.h"
+#include "variant.h"
+
+// Posiciones por tarea al repartir una capa entre los hilos
+#define SOLVE_CHUNK 256
+
+// Partidas al azar de cada verificacion
+#define RULES_CHECK_GAMES 2000
+#define DATABASE_CHECK_GAMES 50
+
+// Mismas jugadas, mismos pases y mismo tablero en las dos implementaciones
+static bool checkRules()
+{
+    for (int game = 0; game < RULES_CHECK_GAMES; game++)
+    {
+        tree_logic tree;
+        startState(tree);
+        VariantState state;
+        startVariant(state, BOARD_SIZE);
+
+        while (true)
+        {
+            Moves expected, moves;
+            if (!tree.gameOver)
+                getValidMoves(tree, expected);
+            getVariantMoves(state, moves);
+
+            auto order = [](Square a, Square b) { return (a.y * BOARD_SIZE + a.x) < (b.y * BOARD_SIZE + b.x); };
+            std::sort(expected.begin(), expected.end(), order);
+            std::sort(moves.begin(), moves.end(), order);
+
+            bool same = tree.gameOver == state.gameOver && tree.currentPlayer == state.currentPlayer &&
+                        expected.size() == moves.size();
+            for (size_t i = 0; same && i < moves.size(); i++)
+                same = (expected[i].x == moves[i].x) && (expected[i].y == moves[i].y);
+            for (int y = 0; same && y < BOARD_SIZE; y++)
+                for (int x = 0; same && x < BOARD_SIZE; x++)
+                    same = tree.board[y][x] == state.board[y][x];
+
+            if (!same)
+            {
+                printf("Las reglas no coinciden en la partida %d\n", game + 1);
+                return false;
+            }
+            if (state.gameOver)
+                break;
+
+            Square move = moves[rand() % moves.size()];
+            playMove(tree, move);
+            playVariantMove(state, move);
+        }
+    }
+    return true;
+}
+
+static void runParallel(size_t count, int threadCount, std::function<void(size_t, int)> const&work)
+{
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < threadCount; t++)
+        threads.emplace_back([&next, count, t, &work]() {
+            size_t begin;
+            while ((begin = next.fetch_add(SOLVE_CHUNK)) < count)
+                for (size_t i = begin; i < std::min(count, begin + SOLVE_CHUNK); i++)
+                    work(i, t);
+        });
+    for (auto &thread : threads)
+        thread.join();
+}
+
+template <int N>
+struct SmallSolver
+{
+    typedef typename VariantBits<N>::Type Bits;
+
+    int minEmpties;
+    int threadCount;
+    std::vector<std::vector<uint64_t>> layers;  // claves ordenadas por casillas vacias
+    std::vector<std::vector<int8_t>> values;
+
+    // Hijo de una jugada: el que mueve en el hijo, o el mismo si el rival pasa
+    static bool playChild(Bits own, Bits opponent, int square, VariantBoard<N> &child)
+    {
+        child = {own, opponent, PLAYER_BLACK, false};
+        return playVariantBoardMove(child, square);
+    }
+
+    void enumerate(Bits own, Bits opponent)
+    {
+        int rootEmpties = N * N - __builtin_popcountll(own | opponent);
+        layers.assign(rootEmpties + 1, std::vector<uint64_t>());
+        values.assign(rootEmpties + 1, std::vector<int8_t>());
+        layers[rootEmpties].push_back(smallDatabaseKey(N, own, opponent));
+
+        for (int empties = rootEmpties; empties > minEmpties; empties--)
+        {
+            std::vector<std::vector<uint64_t>> found(threadCount);
+            std::vector<uint64_t> const&layer = layers[empties];
+
+            runParallel(layer.size(), threadCount, [&](size_t i, int t) {
+                uint64_t parentOwn, parentOpponent;
+                decodeSmallDatabaseKey(N, layer[i], parentOwn, parentOpponent);
+
+                VariantBoard<N> parent = {parentOwn, parentOpponent, PLAYER_BLACK, false};
+                for (Bits moves = getVariantMovesMask(parent); moves; moves &= moves - 1)
+                {
+                    VariantBoard<N> child;
+                    playChild(parentOwn, parentOpponent, __builtin_ctzll(moves), child);
+                    if (child.gameOver)
+                        continue;
+
+                    Bits mover = (child.currentPlayer == PLAYER_BLACK) ? child.black : child.white;
+                    Bits other = (child.currentPlayer == PLAYER_BLACK) ? child.white : child.black;
+                    found[t].push_back(smallDatabaseKey(N, mover, other));
+                }
+            });
+
+            std::vector<uint64_t> &next = layers[empties - 1];
+            for (auto &keys : found)
+            {
+                next.insert(next.end(), keys.begin(), keys.end());
+                std::vector<uint64_t>().swap(keys);
+            }
+            std::sort(next.begin(), next.end());
+            next.erase(std::unique(next.begin(), next.end()), next.end());
+            printf("%d vacias: %zu posiciones\n", empties - 1, next.size());
+            fflush(stdout);
+        }
+    }
+
+    int lookup(int empties, Bits own, Bits opponent) const
+    {
+        std::vector<uint64_t> const&layer = layers[empties];
+        uint64_t key = smallDatabaseKey(N, own, opponent);
+        return values[empties][std::lower_bound(layer.begin(), layer.end(), key) - layer.begin()];
+    }
+
+    void solveLayer(int empties, EvalWeights const&weights)
+    {
+        std::vector<uint64_t> const&layer = layers[empties];
+        values[empties].assign(layer.size(), 0);
+
+        runParallel(layer.size(), threadCount, [&](size_t i, int) {
+            Bits own, opponent;
+            decodeSmallDatabaseKey(N, layer[i], own, opponent);
+            VariantBoard<N> board = {own, opponent, PLAYER_BLACK, false};
+
+            int best;
+            if (empties == minEmpties)
+                best = searchVariantBoard(board, 0, weights).value / FINAL_DISC_VALUE;
+            else
+            {
+                best = -N * N;
+                for (Bits moves = getVariantMovesMask(board); moves; moves &= moves - 1)
+                {
+                    VariantBoard<N> child;
+                    playChild(own, opponent, __builtin_ctzll(moves), child);
+
+                    int value;
+                    if (child.gameOver)
+                        value = __builtin_popcountll(child.black) - __builtin_popcountll(child.white);
+                    else if (child.currentPlayer == PLAYER_BLACK)
+                        value = lookup(empties - 1, child.black, child.white);
+                    else
+                        value = -lookup(empties - 1, child.white, child.black);
+                    best = std::max(best, value);
+                }
+            }
+            values[empties][i] = (int8_t)best;
+        });
+    }
+};
+
+// Verifica la base contra la busqueda exacta en partidas al azar
+static bool checkDatabase(SmallDatabase const&db, VariantState const&root, EvalWeights const&weights)
+{
+    int minEmpties = db.header->minEmpties;
+    int checked = 0;
+
+    for (int game = 0; game < DATABASE_CHECK_GAMES; game++)
+    {
+        VariantState state = root;
+        while (!state.gameOver)
+        {
+            int empties = root.size * root.size - getVariantScore(state, PLAYER_BLACK) -
+                          getVariantScore(state, PLAYER_WHITE);
+            if (empties < minEmpties)
+                break;
+
+            int value, moveValue;
+            Square move;
+            VariantResult result = searchVariant(state, 0, weights);
+            if (!probeSmallDatabase(db, state, value) || value != result.value / FINAL_DISC_VALUE)
+            {
+                printf("La base no coincide con la busqueda exacta (%d vacias)\n", empties);
+                return false;
+            }
+            if (empties > minEmpties &&
+                (!getSmallDatabaseMove(db, state, move, moveValue) || moveValue != value))
+            {
+                printf("La mejor jugada de la base no coincide con su valor (%d vacias)\n", empties);
+                return false;
+            }
+            checked++;
+
+            Moves moves;
+            getVariantMoves(state, moves);
+            playVariantMove(state, moves[rand() % moves.size()]);
+        }
+    }
+
+    printf("Verificadas %d posiciones contra la busqueda exacta\n", checked);
+    return true;
+}
+
+template <int N>
+static bool solve(const char *path, int minEmpties, int threadCount, VariantState const&root,
+                  EvalWeights const&weights)
+{
+    typedef typename VariantBits<N>::Type Bits;
+
+    SmallSolver<N> solver;
+    solver.threadCount = threadCount;
+
+    Bits own = 0, opponent = 0;
+    for (int y = 0; y < N; y++)
+        for (int x = 0; x < N; x++)
+            if (root.board[y][x] != PIECE_EMPTY)
+            {
+                bool mine = (root.board[y][x] == PIECE_BLACK) == (root.currentPlayer == PLAYER_BLACK);
+                (mine ? own : opponent) |= (Bits)1 << (y * N + x);
+            }
+
+    minEmpties = std::min(std::max(minEmpties, 0), N * N - __builtin_popcountll(own | opponent));
+    solver.minEmpties = minEmpties;
+
+    auto start = std::chrono::steady_clock::now();
+    solver.enumerate(own, opponent);
+    double enumerated = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int rootEmpties = (int)solver.layers.size() - 1;
+    for (int empties = minEmpties; empties <= rootEmpties; empties++)
+    {
+        solver.solveLayer(empties, weights);
+        printf("Resueltas %d vacias\n", empties);
+        fflush(stdout);
+    }
+    double solved = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<SmallDatabaseEntry> entries;
+    for (int empties = minEmpties; empties <= rootEmpties; empties++)
+        for (size_t i = 0; i < solver.layers[empties].size(); i++)
+            entries.push_back(SmallDatabaseEntry{solver.layers[empties][i], solver.values[empties][i]});
+
+    int value = solver.values[rootEmpties][0];
+    printf("%dx%d: %zu posiciones en %.1f s (recorrido %.1f s)\n", N, N, entries.size(), solved, enumerated);
+    printf("Con juego perfecto el que mueve %s por %d\n",
+           (value > 0) ? "gana" : (value < 0) ? "pierde" : "empata", std::abs(value));
+
+    if (!writeSmallDatabase(path, N, minEmpties, entries))
+    {
+        printf("No se pudo escribir %s\n", path);
+        return false;
+    }
+
+    SmallDatabase db;
+    if (!openSmallDatabase(db, path))
+    {
+        printf("No se pudo abrir %s\n", path);
+        return false;
+    }
+    bool ok = checkDatabase(db, root, weights);
+    closeSmallDatabase(db);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        printf("Uso: %s <tamaño> <salida.db> [casillas minimas] [hilos] [jugadas]\n", argv[0]);
+        return 1;
+    }
+
+    int size = atoi(argv[1]);
+    const char *path = argv[2];
+    int minEmpties = (argc > 3) ? atoi(argv[3]) : 0;
+    int threadCount = (argc > 4) ? atoi(argv[4]) : (int)std::thread::hardware_concurrency();
+    std::string line = (argc > 5) ? argv[5] : "";
+
+    if (size != 4 && size != 6)
+    {
+        printf("Tamaño no soportado: %d (4 o 6)\n", size);
+        return 1;
+    }
+    if (size == 6 && line.empty())
+    {
+        printf("6x6 completo no entra en memoria: indicar las jugadas de una apertura\n");
+        return 1;
+    }
+    threadCount = std::max(threadCount, 1);
+
+    loadConfig(CONFIG_DEFAULT_PATH);
+    EvalWeights weights = getConfig().weights;
+    srand(1);
+
+    if (!checkRules())
+        return 1;
+    printf("Reglas de 8x8 iguales a las de model.cpp en %d partidas\n", RULES_CHECK_GAMES);
+
+    VariantState root;
+    startVariant(root, size);
+    for (size_t i = 0; i + 1 < line.size(); i += 2)
+    {
+        Square move = {line[i] - 'A', line[i + 1] - '1'};
+        if (!playVariantMove(root, move))
+        {
+            printf("Jugada invalida: %s\n", line.substr(i, 2).c_str());
+            return 1;
+        }
+    }
+    if (root.gameOver)
+    {
+        printf("La partida ya termino\n");
+        return 1;
+    }
+
+    bool ok = (size == 4) ? solve<4>(path, minEmpties, threadCount, root, weights)
+                          : solve<6>(path, minEmpties, threadCount, root, weights);
+    return ok ? 0 : 1;
+}
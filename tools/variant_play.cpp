@@ -0,0 +1,111 @@
+/**
+ * @brief Self-play on the 4x4, 6x6, 8x8 and 10x10 board variants
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ *
+ * Uso: variant_play <tamaño> [partidas] [profundidad negras] [profundidad blancas] [base.db]
+ *
+ * Cada partida empieza con dos jugadas al azar para que no se repitan, y se
+ * imprime como transcripcion con las coordenadas de la variante (A1 a J10).
+ * Con una base de small_solve del mismo tamaño, las posiciones que estan en
+ * la base se juegan perfectas sin buscar.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "config.h"
+#include "smalldb.h"
+#include "variant.h"
+
+static std::string formatSquare(Square square)
+{
+    return std::string(1, (char)('A' + square.x)) + std::to_string(square.y + 1);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("Uso: %s <tamaño> [partidas] [profundidad negras] [profundidad blancas] [base.db]\n",
+               argv[0]);
+        return 1;
+    }
+
+    int size = atoi(argv[1]);
+    int games = (argc > 2) ? atoi(argv[2]) : 1;
+    int depths[2];
+    depths[PLAYER_BLACK] = (argc > 3) ? atoi(argv[3]) : 4;
+    depths[PLAYER_WHITE] = (argc > 4) ? atoi(argv[4]) : depths[PLAYER_BLACK];
+
+    if (!isVariantSize(size))
+    {
+        printf("Tamaño no soportado: %d (4, 6, 8 o 10)\n", size);
+        return 1;
+    }
+
+    SmallDatabase db;
+    db.mapping = nullptr;
+    if (argc > 5 && !openSmallDatabase(db, argv[5]))
+    {
+        printf("No se pudo abrir la base %s\n", argv[5]);
+        return 1;
+    }
+
+    loadConfig(CONFIG_DEFAULT_PATH);
+    EvalWeights weights = getConfig().weights;
+    srand(1);
+
+    int wins[2] = {0, 0};
+    long nodes = 0;
+    int perfect = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int game = 0; game < games; game++)
+    {
+        VariantState state;
+        startVariant(state, size);
+        std::string transcript;
+
+        for (int ply = 0; !state.gameOver; ply++)
+        {
+            Moves moves;
+            getVariantMoves(state, moves);
+
+            Square move = moves[rand() % moves.size()];
+            int value;
+            if (ply >= 2 && getSmallDatabaseMove(db, state, move, value))
+                perfect++;
+            else if (ply >= 2)
+            {
+                VariantResult result = searchVariant(state, depths[state.currentPlayer], weights);
+                move = result.bestMove;
+                nodes += result.nodes;
+            }
+
+            playVariantMove(state, move);
+            transcript += formatSquare(move);
+        }
+
+        int black = getVariantScore(state, PLAYER_BLACK);
+        int white = getVariantScore(state, PLAYER_WHITE);
+        if (black != white)
+            wins[(black > white) ? PLAYER_BLACK : PLAYER_WHITE]++;
+
+        printf("Partida %d/%d: %d-%d %s\n", game + 1, games, black, white, transcript.c_str());
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%dx%d, profundidad %d contra %d: negras %d, blancas %d, empates %d\n",
+           size, size, depths[PLAYER_BLACK], depths[PLAYER_WHITE],
+           wins[PLAYER_BLACK], wins[PLAYER_WHITE], games - wins[PLAYER_BLACK] - wins[PLAYER_WHITE]);
+    printf("Nodos: %ld, %.0f nodos/s\n", nodes, nodes / seconds);
+    if (db.mapping != nullptr)
+        printf("Jugadas de la base: %d\n", perfect);
+
+    closeSmallDatabase(db);
+    return 0;
+}
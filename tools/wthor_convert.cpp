@@ -0,0 +1,289 @@
+/**
+ * @brief Imports WTHOR / transcript games into a game archive and exports them back
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ *
+ * Uso: wthor_convert import <archivo.edb> <entrada.wtb|.txt>...
+ *      wthor_convert export <archivo.edb> <salida.wtb|.txt>
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "gamedb.h"
+#include "wthor.h"
+
+// Partidas que se validan juntas antes de escribirlas
+#define IMPORT_BATCH_SIZE (1 << 16)
+
+struct ImportedGame
+{
+    uint64_t hash;
+    int moveCount;              // -1 = invalida
+    int discDiff;
+    uint8_t moves[WTHOR_MAX_MOVES];
+};
+
+struct ImportStats
+{
+    long read;
+    long invalid;
+    long duplicates;
+    long imported;
+};
+
+static bool hasExtension(std::string const&path, const char *extension)
+{
+    size_t length = strlen(extension);
+    return path.size() >= length &&
+           path.compare(path.size() - length, length, extension) == 0;
+}
+
+static bool readFile(const char *path, std::vector<uint8_t> &data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    file.seekg(0, std::ios::end);
+    data.resize((size_t)file.tellg());
+    file.seekg(0, std::ios::beg);
+    file.read((char *)data.data(), data.size());
+    return (bool)file;
+}
+
+// Valida y calcula la clave de cada partida; corre en varios hilos
+static void processGames(std::vector<ImportedGame> &games, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        ImportedGame &game = games[i];
+        if (game.moveCount < 0 || !validateGame(game.moves, game.moveCount, game.discDiff))
+        {
+            game.moveCount = -1;
+            continue;
+        }
+        game.hash = canonicalGameHash(game.moves, game.moveCount);
+    }
+}
+
+static void processBatch(std::vector<ImportedGame> &games, unsigned threadCount)
+{
+    std::vector<std::thread> threads;
+    size_t chunk = (games.size() + threadCount - 1) / threadCount;
+
+    for (unsigned t = 0; t < threadCount; t++)
+    {
+        size_t begin = t * chunk;
+        size_t end = std::min(games.size(), begin + chunk);
+        if (begin < end)
+            threads.emplace_back(processGames, std::ref(games), begin, end);
+    }
+    for (auto &thread : threads)
+        thread.join();
+}
+
+// Escribe en orden las partidas validas que no estaban
+static bool writeBatch(std::vector<ImportedGame> &games, GameDatabaseWriter &writer,
+                       std::unordered_set<uint64_t> &known, ImportStats &stats)
+{
+    for (auto const&game : games)
+    {
+        stats.read++;
+        if (game.moveCount < 0)
+        {
+            stats.invalid++;
+            continue;
+        }
+        if (!known.insert(game.hash).second)
+        {
+            stats.duplicates++;
+            continue;
+        }
+        if (!appendGame(writer, game.moves, game.moveCount, game.discDiff))
+            return false;
+        stats.imported++;
+    }
+
+    games.clear();
+    return true;
+}
+
+static bool importFile(const char *path, GameDatabaseWriter &writer,
+                       std::unordered_set<uint64_t> &known, ImportStats &stats,
+                       unsigned threadCount)
+{
+    std::vector<uint8_t> data;
+    if (!readFile(path, data))
+    {
+        printf("No se pudo leer %s\n", path);
+        return false;
+    }
+
+    std::vector<ImportedGame> games;
+    games.reserve(IMPORT_BATCH_SIZE);
+
+    bool wthor = hasExtension(path, ".wtb") || hasExtension(path, ".WTB");
+    size_t position = 0;
+
+    if (wthor)
+    {
+        WthorHeader header;
+        if (data.size() < WTHOR_HEADER_SIZE || !readWthorHeader(data.data(), header))
+        {
+            printf("%s no es un archivo WTHOR de 8x8\n", path);
+            return false;
+        }
+        position = WTHOR_HEADER_SIZE;
+    }
+
+    while (position < data.size())
+    {
+        ImportedGame game;
+        game.hash = 0;
+        game.discDiff = 0;
+
+        if (wthor)
+        {
+            if (position + WTHOR_RECORD_SIZE > data.size())
+                break;
+            game.moveCount = readWthorGame(data.data() + position, game.moves);
+            position += WTHOR_RECORD_SIZE;
+        }
+        else
+        {
+            size_t end = position;
+            while (end < data.size() && data[end] != '\n')
+                end++;
+            std::string line((const char *)data.data() + position, end - position);
+            position = end + 1;
+
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+                continue;
+            game.moveCount = parseTranscript(line, game.moves);
+        }
+
+        games.push_back(game);
+        if (games.size() == IMPORT_BATCH_SIZE)
+        {
+            processBatch(games, threadCount);
+            if (!writeBatch(games, writer, known, stats))
+                return false;
+        }
+    }
+
+    processBatch(games, threadCount);
+    return writeBatch(games, writer, known, stats);
+}
+
+static int importGames(const char *archivePath, int inputCount, char *inputs[])
+{
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    auto start = std::chrono::steady_clock::now();
+
+    // Las partidas que ya estan en el archivo cuentan como repetidas
+    std::unordered_set<uint64_t> known;
+    GameDatabase db;
+    if (openGameDatabase(db, archivePath))
+    {
+        uint64_t cursor = 0;
+        GameView game;
+        while (nextGame(db, cursor, game))
+            known.insert(canonicalGameHash(game.moves, game.moveCount));
+        closeGameDatabase(db);
+    }
+
+    GameDatabaseWriter writer;
+    if (!openGameDatabaseWriter(writer, archivePath))
+    {
+        printf("No se pudo abrir %s\n", archivePath);
+        return 1;
+    }
+
+    ImportStats stats = {0, 0, 0, 0};
+    bool ok = true;
+    for (int i = 0; i < inputCount; i++)
+        ok = importFile(inputs[i], writer, known, stats, threadCount) && ok;
+    closeGameDatabaseWriter(writer);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("Leidas %ld, invalidas %ld, repetidas %ld, importadas %ld en %.2f s (%u hilos)\n",
+           stats.read, stats.invalid, stats.duplicates, stats.imported, seconds, threadCount);
+    return ok ? 0 : 1;
+}
+
+static int exportGames(const char *archivePath, const char *outputPath)
+{
+    GameDatabase db;
+    if (!openGameDatabase(db, archivePath))
+    {
+        printf("No se pudo abrir %s\n", archivePath);
+        return 1;
+    }
+
+    FILE *file = fopen(outputPath, "wb");
+    if (!file)
+    {
+        printf("No se pudo escribir %s\n", outputPath);
+        closeGameDatabase(db);
+        return 1;
+    }
+
+    bool wthor = hasExtension(outputPath, ".wtb") || hasExtension(outputPath, ".WTB");
+    uint8_t record[WTHOR_RECORD_SIZE];
+    uint64_t cursor = 0;
+    GameView game;
+    int count = 0;
+
+    // La cantidad de partidas va en la cabecera: se completa al final
+    if (wthor)
+    {
+        writeWthorHeader(record, 0);
+        fwrite(record, 1, WTHOR_HEADER_SIZE, file);
+    }
+
+    while (nextGame(db, cursor, game))
+    {
+        if (wthor)
+        {
+            writeWthorGame(record, game.moves, game.moveCount);
+            fwrite(record, 1, WTHOR_RECORD_SIZE, file);
+        }
+        else
+        {
+            fprintf(file, "%s\n", formatTranscript(game.moves, game.moveCount).c_str());
+        }
+        count++;
+    }
+
+    if (wthor)
+    {
+        writeWthorHeader(record, count);
+        fseek(file, 0, SEEK_SET);
+        fwrite(record, 1, WTHOR_HEADER_SIZE, file);
+    }
+
+    fclose(file);
+    closeGameDatabase(db);
+    printf("Exportadas %d partidas a %s\n", count, outputPath);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc >= 4 && strcmp(argv[1], "import") == 0)
+        return importGames(argv[2], argc - 3, argv + 3);
+    if (argc == 4 && strcmp(argv[1], "export") == 0)
+        return exportGames(argv[2], argv[3]);
+
+    printf("Uso: %s import <archivo.edb> <entrada.wtb|.txt>...\n", argv[0]);
+    printf("     %s export <archivo.edb> <salida.wtb|.txt>\n", argv[0]);
+    return 1;
+}
@@ -0,0 +1,141 @@
+/**
+ * @brief Timeline of the search in Chrome Trace Event format
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "trace.h"
+
+#ifdef EDAVERSI_TRACE
+
+struct TraceSpan
+{
+    const char *name;
+    const char *argName;
+    int arg;
+    int thread;
+    double start;
+    double duration;
+};
+
+struct TraceFile
+{
+    std::mutex mutex;
+    std::string path;
+    FILE *file;
+    bool empty;                 // todavia no se escribio ningun evento
+    std::vector<TraceSpan> spans;
+    int threads;
+};
+
+std::atomic<bool> g_traceEnabled(false);
+
+static TraceFile g_trace;
+static const std::chrono::steady_clock::time_point g_traceOrigin = std::chrono::steady_clock::now();
+
+double traceNow()
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - g_traceOrigin).count();
+}
+
+// Numero chico por hilo, en orden de primera traza: el visor los muestra
+// como filas
+static int traceThread()
+{
+    thread_local int thread = 0;
+    if (thread == 0)
+        thread = ++g_trace.threads;
+    return thread;
+}
+
+void addTraceSpan(const char *name, const char *argName, int arg, double start)
+{
+    double end = traceNow();
+    std::lock_guard<std::mutex> lock(g_trace.mutex);
+    if (g_trace.file != nullptr)
+        g_trace.spans.push_back(TraceSpan{name, argName, arg, traceThread(), start, end - start});
+}
+
+static void writeSpans()
+{
+    for (auto const&span : g_trace.spans)
+    {
+        fprintf(g_trace.file, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": %d, \"tid\": %d, \"ts\": %.1f, \"dur\": %.1f",
+                g_trace.empty ? "" : ",\n", span.name, (int)getpid(), span.thread, span.start, span.duration);
+        if (span.argName != nullptr)
+            fprintf(g_trace.file, ", \"args\": {\"%s\": %d}", span.argName, span.arg);
+        fprintf(g_trace.file, "}");
+        g_trace.empty = false;
+    }
+    g_trace.spans.clear();
+    fflush(g_trace.file);
+}
+
+bool openTrace(const char *path)
+{
+    std::lock_guard<std::mutex> lock(g_trace.mutex);
+    if (g_trace.file != nullptr && g_trace.path == path)
+        return true;
+
+    g_traceEnabled = false;
+    if (g_trace.file != nullptr)
+    {
+        writeSpans();
+        fprintf(g_trace.file, "\n]\n");
+        fclose(g_trace.file);
+        g_trace.file = nullptr;
+    }
+    g_trace.path = path;
+    if (g_trace.path.empty())
+        return true;
+
+    g_trace.file = fopen(path, "w");
+    if (g_trace.file == nullptr)
+        return false;
+
+    fprintf(g_trace.file, "[\n");
+    g_trace.empty = true;
+    g_traceEnabled = true;
+    return true;
+}
+
+void flushTrace()
+{
+    if (!g_traceEnabled.load(std::memory_order_relaxed))
+        return;
+
+    std::lock_guard<std::mutex> lock(g_trace.mutex);
+    if (g_trace.file != nullptr)
+        writeSpans();
+}
+
+bool isTraceCompiled()
+{
+    return true;
+}
+
+#else
+
+bool openTrace(const char *path)
+{
+    return path[0] == '\0';
+}
+
+void flushTrace()
+{
+}
+
+bool isTraceCompiled()
+{
+    return false;
+}
+
+#endif
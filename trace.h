@@ -0,0 +1,93 @@
+/**
+ * @brief Timeline of the search in Chrome Trace Event format
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+
+// Las trazas se compilan con -DEDAVERSI_TRACE=ON en cmake. Sin eso,
+// TRACE_SCOPE no genera codigo; con eso y sin archivo abierto, cuesta una
+// lectura atomica por tramo.
+#ifdef EDAVERSI_TRACE
+
+extern std::atomic<bool> g_traceEnabled;
+
+/**
+ * @brief Microseconds since the trace was opened.
+ *
+ * @return The time.
+ */
+double traceNow();
+
+/**
+ * @brief Records a finished span.
+ *
+ * @param name The span, a string literal.
+ * @param argName The name of the argument, a string literal, or nullptr.
+ * @param arg The argument.
+ * @param start The start, from traceNow.
+ */
+void addTraceSpan(const char *name, const char *argName, int arg, double start);
+
+// Tramo desde la declaracion hasta el fin del bloque
+struct TraceScope
+{
+    const char *name;
+    const char *argName;
+    int arg;
+    double start;               // -1 = trazas apagadas al empezar
+
+    TraceScope(const char *name, const char *argName = nullptr, int arg = 0)
+        : name(name), argName(argName), arg(arg),
+          start(g_traceEnabled.load(std::memory_order_relaxed) ? traceNow() : -1)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (start >= 0)
+            addTraceSpan(name, argName, arg, start);
+    }
+};
+
+#define TRACE_JOIN2(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN2(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_JOIN(traceScope, __LINE__)(name)
+#define TRACE_SCOPE_ARG(name, argName, arg) TraceScope TRACE_JOIN(traceScope, __LINE__)(name, argName, arg)
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SCOPE_ARG(name, argName, arg) ((void)0)
+
+#endif
+
+/**
+ * @brief Starts writing spans to a file, closing the previous one. The file
+ *        is a JSON array of events that Perfetto and chrome://tracing open
+ *        even if the closing bracket is missing.
+ *
+ * @param path The file, or an empty string to stop tracing.
+ * @return Tracing to path. False if it cannot be opened or the build has no
+ *         tracing.
+ */
+bool openTrace(const char *path);
+
+/**
+ * @brief Writes the spans recorded so far.
+ */
+void flushTrace();
+
+/**
+ * @brief Tells whether tracing was compiled in.
+ *
+ * @return EDAVERSI_TRACE was set.
+ */
+bool isTraceCompiled();
+
+#endif
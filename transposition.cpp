@@ -0,0 +1,228 @@
+/**
+ * @brief Transposition table for the Reversi game AI
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <cstddef>
+#include <sys/mman.h>
+
+#include "transposition.h"
+
+#define SQUARE_COUNT (BOARD_SIZE * BOARD_SIZE)
+
+// Claves al azar fijas: una por casilla y color, otra para el turno de las
+// blancas y otra por casilla para contexto extra (ultima jugada)
+struct ZobristKeys
+{
+    uint64_t pieces[2][SQUARE_COUNT];
+    uint64_t flip[SQUARE_COUNT];        // pieces[0] ^ pieces[1]
+    uint64_t whiteToMove;
+    uint64_t extra[SQUARE_COUNT];
+
+    ZobristKeys()
+    {
+        uint64_t seed = 0x2545f4914f6cdd1dULL;
+
+        for (int i = 0; i < SQUARE_COUNT; i++)
+        {
+            pieces[0][i] = next(seed);
+            pieces[1][i] = next(seed);
+            flip[i] = pieces[0][i] ^ pieces[1][i];
+            extra[i] = next(seed);
+        }
+        whiteToMove = next(seed);
+    }
+
+    // splitmix64
+    static uint64_t next(uint64_t &state)
+    {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+};
+
+static const ZobristKeys g_zobrist;
+
+void TTUnmap::operator()(TTSlot *slots) const
+{
+    munmap(slots, bytes);
+}
+
+void initTranspositionTable(TranspositionTable &table, int sizeMB, bool hugePages)
+{
+    size_t count = 0;
+
+    if (sizeMB > 0)
+    {
+        size_t wanted = ((size_t)sizeMB << 20) / sizeof(TTSlot);
+        count = 1;
+        while (count * 2 <= wanted)
+            count *= 2;
+    }
+
+    table.slots.reset();
+    table.size = 0;
+    table.mask = 0;
+    table.generation = 0;
+    table.hugePages = false;
+    if (count == 0)
+        return;
+
+    // Las paginas enormes se piden sobre memoria alineada a 2 MB
+    size_t bytes = count * sizeof(TTSlot);
+    if (hugePages)
+        bytes = (bytes + TT_HUGE_PAGE_SIZE - 1) / TT_HUGE_PAGE_SIZE * TT_HUGE_PAGE_SIZE;
+
+    void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return;
+#ifdef MADV_HUGEPAGE
+    if (hugePages)
+        table.hugePages = madvise(memory, bytes, MADV_HUGEPAGE) == 0;
+#endif
+
+    // mmap devuelve memoria en cero: todas las entradas vacias
+    table.slots = std::unique_ptr<TTSlot[], TTUnmap>((TTSlot *)memory, TTUnmap{bytes});
+    table.size = count;
+    table.mask = count - 1;
+}
+
+bool isTranspositionTableEnabled(TranspositionTable const&table)
+{
+    return table.size > 0;
+}
+
+void clearTranspositionTable(TranspositionTable &table)
+{
+    for (size_t i = 0; i < table.size; i++)
+    {
+        table.slots[i].check.store(0, std::memory_order_relaxed);
+        table.slots[i].data.store(0, std::memory_order_relaxed);
+    }
+    table.generation = 0;
+}
+
+void newSearchGeneration(TranspositionTable &table)
+{
+    table.generation++;
+}
+
+// data: valor en los 32 bits bajos, despues altura + 1 (0 = vacia), cota,
+// jugada y generacion
+static uint64_t packEntry(int value, int height, TTBound bound, uint8_t bestMove, uint8_t generation)
+{
+    return (uint64_t)(uint32_t)value |
+           ((uint64_t)(uint8_t)(height + 1) << 32) |
+           ((uint64_t)bound << 40) |
+           ((uint64_t)bestMove << 48) |
+           ((uint64_t)generation << 56);
+}
+
+static TTEntry unpackEntry(uint64_t check, uint64_t data)
+{
+    TTEntry entry;
+    entry.key = check ^ data;
+    entry.value = (int32_t)(uint32_t)data;
+    entry.height = (int8_t)((int)((data >> 32) & 0xff) - 1);
+    entry.bound = (uint8_t)(data >> 40);
+    entry.bestMove = (uint8_t)(data >> 48);
+    entry.generation = (uint8_t)(data >> 56);
+    return entry;
+}
+
+void prefetchTranspositionTable(TranspositionTable const&table, uint64_t key)
+{
+    if (table.size > 0)
+        __builtin_prefetch(&table.slots[key & table.mask]);
+}
+
+bool probeTranspositionTable(TranspositionTable const&table, uint64_t key, TTEntry &entry)
+{
+    if (table.size == 0)
+        return false;
+
+    TTSlot const&slot = table.slots[key & table.mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+    entry = unpackEntry(check, data);
+    return entry.key == key && entry.height >= 0;
+}
+
+void storeTranspositionTable(TranspositionTable &table, uint64_t key, int value,
+                             int height, TTBound bound, Square bestMove)
+{
+    if (table.size == 0)
+        return;
+
+    TTSlot &slot = table.slots[key & table.mask];
+    TTEntry current = unpackEntry(slot.check.load(std::memory_order_relaxed),
+                                  slot.data.load(std::memory_order_relaxed));
+
+    // Se conserva una entrada mas profunda de esta misma busqueda
+    if (current.key != key && current.height >= 0 &&
+        current.generation == table.generation && current.height > height)
+        return;
+
+    uint8_t move = isSquareValid(bestMove)
+                       ? (uint8_t)(bestMove.y * BOARD_SIZE + bestMove.x)
+                       : TT_NO_MOVE;
+    uint64_t data = packEntry(value, height, bound, move, table.generation);
+
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
+
+Square getEntryMove(TTEntry const&entry)
+{
+    if (entry.bestMove == TT_NO_MOVE)
+        return GAME_INVALID_SQUARE;
+    return Square{entry.bestMove % BOARD_SIZE, entry.bestMove / BOARD_SIZE};
+}
+
+uint64_t zobristHash(tree_logic const&tree)
+{
+    uint64_t hash = 0;
+
+    for (int y = 0; y < BOARD_SIZE; y++)
+        for (int x = 0; x < BOARD_SIZE; x++)
+        {
+            if (tree.board[y][x] == PIECE_BLACK)
+                hash ^= g_zobrist.pieces[PLAYER_BLACK][y * BOARD_SIZE + x];
+            else if (tree.board[y][x] == PIECE_WHITE)
+                hash ^= g_zobrist.pieces[PLAYER_WHITE][y * BOARD_SIZE + x];
+        }
+
+    if (tree.currentPlayer == PLAYER_WHITE)
+        hash ^= g_zobrist.whiteToMove;
+
+    return hash;
+}
+
+uint64_t zobristUpdate(uint64_t hash, Square move, FlipMask flips,
+                       Player mover, Player nextPlayer)
+{
+    hash ^= g_zobrist.pieces[mover][move.y * BOARD_SIZE + move.x];
+
+    while (flips)
+    {
+        hash ^= g_zobrist.flip[__builtin_ctzll(flips)];
+        flips &= flips - 1;
+    }
+
+    if (mover != nextPlayer)
+        hash ^= g_zobrist.whiteToMove;
+
+    return hash;
+}
+
+uint64_t zobristSquare(Square square)
+{
+    if (!isSquareValid(square))
+        return 0;
+    return g_zobrist.extra[square.y * BOARD_SIZE + square.x];
+}
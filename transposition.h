@@ -0,0 +1,164 @@
+/**
+ * @brief Transposition table for the Reversi game AI
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "model.h"
+
+#define TT_NO_MOVE 0xff
+#define TT_HUGE_PAGE_SIZE (2 << 20)
+
+enum TTBound
+{
+    TT_EXACT,
+    TT_LOWER,
+    TT_UPPER,
+};
+
+struct TTEntry
+{
+    uint64_t key;
+    int32_t value;
+    int8_t height;              // profundidad restante con la que se busco
+    uint8_t bound;
+    uint8_t bestMove;           // y * BOARD_SIZE + x, TT_NO_MOVE si no hay
+    uint8_t generation;
+};
+
+// Entrada guardada sin trabas: check = clave ^ data. Si dos hilos escriben a
+// la vez y la entrada queda mezclada, la clave no coincide y es un fallo.
+struct TTSlot
+{
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
+};
+
+// Libera la memoria mapeada de la tabla
+struct TTUnmap
+{
+    size_t bytes;
+    void operator()(TTSlot *slots) const;
+};
+
+struct TranspositionTable
+{
+    std::unique_ptr<TTSlot[], TTUnmap> slots;
+    size_t size;
+    uint64_t mask;
+    uint8_t generation;
+    bool hugePages;             // la memoria se pidio con paginas de 2 MB
+};
+
+/**
+ * @brief Allocates an empty table. Several threads can probe and store at
+ *        the same time without locks.
+ *
+ * @param table The table.
+ * @param sizeMB Size in megabytes, rounded down to a power of two entries.
+ *               0 leaves the table disabled.
+ * @param hugePages Ask the kernel for 2 MB pages, which saves TLB misses on
+ *                  random probes. Falls back to normal pages.
+ */
+void initTranspositionTable(TranspositionTable &table, int sizeMB, bool hugePages);
+
+/**
+ * @brief Checks whether a table holds entries.
+ *
+ * @param table The table.
+ * @return It has entries.
+ */
+bool isTranspositionTableEnabled(TranspositionTable const&table);
+
+/**
+ * @brief Empties a table.
+ *
+ * @param table The table.
+ */
+void clearTranspositionTable(TranspositionTable &table);
+
+/**
+ * @brief Starts a new search: older entries become cheaper to replace.
+ *
+ * @param table The table.
+ */
+void newSearchGeneration(TranspositionTable &table);
+
+/**
+ * @brief Brings the entry of a position into the cache ahead of the probe.
+ *
+ * @param table The table.
+ * @param key The position key.
+ */
+void prefetchTranspositionTable(TranspositionTable const&table, uint64_t key);
+
+/**
+ * @brief Looks up a position.
+ *
+ * @param table The table.
+ * @param key The position key.
+ * @param entry Receives the entry.
+ * @return Found.
+ */
+bool probeTranspositionTable(TranspositionTable const&table, uint64_t key, TTEntry &entry);
+
+/**
+ * @brief Stores a search result.
+ *
+ * @param table The table.
+ * @param key The position key.
+ * @param value The value.
+ * @param height The remaining depth of the search.
+ * @param bound Whether value is exact or a bound.
+ * @param bestMove The best move, or GAME_INVALID_SQUARE.
+ */
+void storeTranspositionTable(TranspositionTable &table, uint64_t key, int value,
+                             int height, TTBound bound, Square bestMove);
+
+/**
+ * @brief Decodes the move of an entry.
+ *
+ * @param entry The entry.
+ * @return The move, or GAME_INVALID_SQUARE.
+ */
+Square getEntryMove(TTEntry const&entry);
+
+/**
+ * @brief Zobrist key of a position, including the player to move.
+ *
+ * @param tree The tree logic state.
+ * @return The key.
+ */
+uint64_t zobristHash(tree_logic const&tree);
+
+/**
+ * @brief Updates a Zobrist key after makeMove.
+ *
+ * @param hash The key before the move.
+ * @param move The move.
+ * @param flips The flipped pieces returned by makeMove.
+ * @param mover The player that moved.
+ * @param nextPlayer The player to move afterwards.
+ * @return The new key.
+ */
+uint64_t zobristUpdate(uint64_t hash, Square move, FlipMask flips,
+                       Player mover, Player nextPlayer);
+
+/**
+ * @brief Random key for a square, to mix extra context into a position key.
+ *
+ * @param square The square.
+ * @return The key.
+ */
+uint64_t zobristSquare(Square square);
+
+#endif
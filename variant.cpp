@@ -0,0 +1,468 @@
+/**
+ * @brief Board-size generic Reversi engine for the 4x4, 6x6, 8x8 and 10x10 variants
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <cstring>
+
+#include "ai.h"
+#include "variant.h"
+
+// Mascaras generadas en tiempo de compilacion para cada tamaño
+
+template <typename Bits>
+constexpr Bits squareMask(int size, int x, int y)
+{
+    return (Bits)1 << (y * size + x);
+}
+
+template <typename Bits>
+constexpr Bits columnMask(int size, int x, int y = 0)
+{
+    return (y >= size) ? 0 : (squareMask<Bits>(size, x, y) | columnMask<Bits>(size, x, y + 1));
+}
+
+template <typename Bits>
+constexpr Bits boardMask(int size, int square = 0)
+{
+    return (square >= size * size) ? 0 : (((Bits)1 << square) | boardMask<Bits>(size, square + 1));
+}
+
+template <typename Bits>
+constexpr Bits cornersMask(int size)
+{
+    return squareMask<Bits>(size, 0, 0) | squareMask<Bits>(size, size - 1, 0) |
+           squareMask<Bits>(size, 0, size - 1) | squareMask<Bits>(size, size - 1, size - 1);
+}
+
+// Casillas vecinas a una esquina (X y C)
+template <typename Bits>
+constexpr Bits cornerNeighbours(int size, int x, int y)
+{
+    return squareMask<Bits>(size, x ? x - 1 : 1, y) |
+           squareMask<Bits>(size, x, y ? y - 1 : 1) |
+           squareMask<Bits>(size, x ? x - 1 : 1, y ? y - 1 : 1);
+}
+
+// Desplazamiento de todo el tablero una casilla en la direccion (DX, DY),
+// descartando lo que sale del tablero o da la vuelta por un costado
+template <int N, int DX, int DY>
+struct VariantDirection
+{
+    typedef typename VariantBits<N>::Type Bits;
+
+    static constexpr int offset = DX + DY * N;
+    static constexpr Bits mask = boardMask<Bits>(N) &
+        ~((DX > 0) ? columnMask<Bits>(N, 0) : (DX < 0) ? columnMask<Bits>(N, N - 1) : (Bits)0);
+
+    static inline Bits shift(Bits bits)
+    {
+        return ((offset > 0) ? (bits << (offset > 0 ? offset : 0))
+                             : (bits >> (offset < 0 ? -offset : 0))) & mask;
+    }
+};
+
+static inline int popCount(uint64_t bits)
+{
+    return __builtin_popcountll(bits);
+}
+
+static inline int popCount(unsigned __int128 bits)
+{
+    return __builtin_popcountll((uint64_t)bits) + __builtin_popcountll((uint64_t)(bits >> 64));
+}
+
+static inline int lowestSquare(uint64_t bits)
+{
+    return __builtin_ctzll(bits);
+}
+
+static inline int lowestSquare(unsigned __int128 bits)
+{
+    uint64_t low = (uint64_t)bits;
+    return low ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t)(bits >> 64));
+}
+
+// Cadenas de fichas rivales en una direccion que terminan en una vacia
+template <int N, int DX, int DY>
+static inline typename VariantBits<N>::Type directionMoves(typename VariantBits<N>::Type own,
+                                                           typename VariantBits<N>::Type opponent,
+                                                           typename VariantBits<N>::Type empty)
+{
+    typedef VariantDirection<N, DX, DY> Direction;
+
+    typename VariantBits<N>::Type chain = Direction::shift(own) & opponent;
+    for (int i = 0; i < N - 3; i++)
+        chain |= Direction::shift(chain) & opponent;
+
+    return Direction::shift(chain) & empty;
+}
+
+template <int N>
+static typename VariantBits<N>::Type getMoves(typename VariantBits<N>::Type own,
+                                              typename VariantBits<N>::Type opponent)
+{
+    typename VariantBits<N>::Type empty = boardMask<typename VariantBits<N>::Type>(N) & ~(own | opponent);
+
+    return directionMoves<N, 1, 0>(own, opponent, empty) |
+           directionMoves<N, -1, 0>(own, opponent, empty) |
+           directionMoves<N, 0, 1>(own, opponent, empty) |
+           directionMoves<N, 0, -1>(own, opponent, empty) |
+           directionMoves<N, 1, 1>(own, opponent, empty) |
+           directionMoves<N, -1, 1>(own, opponent, empty) |
+           directionMoves<N, 1, -1>(own, opponent, empty) |
+           directionMoves<N, -1, -1>(own, opponent, empty);
+}
+
+template <int N, int DX, int DY>
+static inline typename VariantBits<N>::Type directionFlips(typename VariantBits<N>::Type start,
+                                                           typename VariantBits<N>::Type own,
+                                                           typename VariantBits<N>::Type opponent)
+{
+    typedef VariantDirection<N, DX, DY> Direction;
+
+    typename VariantBits<N>::Type line = 0;
+    typename VariantBits<N>::Type current = Direction::shift(start);
+
+    while (current & opponent)
+    {
+        line |= current;
+        current = Direction::shift(current);
+    }
+
+    return (current & own) ? line : 0;
+}
+
+template <int N>
+static typename VariantBits<N>::Type getFlips(int square, typename VariantBits<N>::Type own,
+                                              typename VariantBits<N>::Type opponent)
+{
+    typename VariantBits<N>::Type start = (typename VariantBits<N>::Type)1 << square;
+
+    if ((own | opponent) & start)
+        return 0;
+
+    return directionFlips<N, 1, 0>(start, own, opponent) |
+           directionFlips<N, -1, 0>(start, own, opponent) |
+           directionFlips<N, 0, 1>(start, own, opponent) |
+           directionFlips<N, 0, -1>(start, own, opponent) |
+           directionFlips<N, 1, 1>(start, own, opponent) |
+           directionFlips<N, -1, 1>(start, own, opponent) |
+           directionFlips<N, 1, -1>(start, own, opponent) |
+           directionFlips<N, -1, -1>(start, own, opponent);
+}
+
+template <int N>
+void startVariantBoard(VariantBoard<N> &board)
+{
+    typedef typename VariantBits<N>::Type Bits;
+
+    board.white = squareMask<Bits>(N, N / 2 - 1, N / 2 - 1) | squareMask<Bits>(N, N / 2, N / 2);
+    board.black = squareMask<Bits>(N, N / 2, N / 2 - 1) | squareMask<Bits>(N, N / 2 - 1, N / 2);
+    board.currentPlayer = PLAYER_BLACK;
+    board.gameOver = false;
+}
+
+template <int N>
+typename VariantBits<N>::Type getVariantMovesMask(VariantBoard<N> const&board)
+{
+    if (board.currentPlayer == PLAYER_BLACK)
+        return getMoves<N>(board.black, board.white);
+    return getMoves<N>(board.white, board.black);
+}
+
+template <int N>
+bool playVariantBoardMove(VariantBoard<N> &board, int square)
+{
+    typedef typename VariantBits<N>::Type Bits;
+
+    if (board.gameOver || square < 0 || square >= N * N)
+        return false;
+
+    Bits &own = (board.currentPlayer == PLAYER_BLACK) ? board.black : board.white;
+    Bits &opponent = (board.currentPlayer == PLAYER_BLACK) ? board.white : board.black;
+
+    Bits flips = getFlips<N>(square, own, opponent);
+    if (!flips)
+        return false;
+
+    own |= flips | ((Bits)1 << square);
+    opponent &= ~flips;
+
+    // Si el rival no puede jugar, repite el mismo jugador; si ninguno puede, termina
+    if (getMoves<N>(opponent, own))
+        board.currentPlayer = (board.currentPlayer == PLAYER_BLACK) ? PLAYER_WHITE : PLAYER_BLACK;
+    else if (!getMoves<N>(own, opponent))
+        board.gameOver = true;
+
+    return true;
+}
+
+// Busqueda negamax: un solo par de bitboards desde el punto de vista del que mueve
+template <int N>
+struct VariantSearch
+{
+    typedef typename VariantBits<N>::Type Bits;
+
+    EvalWeights weights;
+    int nodes;
+
+    int evaluate(Bits own, Bits opponent, Bits ownMoves)
+    {
+        const Bits corners = cornersMask<Bits>(N);
+
+        // Vecinas de las esquinas vacias: regalan la esquina al rival
+        Bits empty = boardMask<Bits>(N) & ~(own | opponent);
+        Bits risky = 0;
+        if (empty & squareMask<Bits>(N, 0, 0))
+            risky |= cornerNeighbours<Bits>(N, 0, 0);
+        if (empty & squareMask<Bits>(N, N - 1, 0))
+            risky |= cornerNeighbours<Bits>(N, N - 1, 0);
+        if (empty & squareMask<Bits>(N, 0, N - 1))
+            risky |= cornerNeighbours<Bits>(N, 0, N - 1);
+        if (empty & squareMask<Bits>(N, N - 1, N - 1))
+            risky |= cornerNeighbours<Bits>(N, N - 1, N - 1);
+
+        int pieces = popCount(own) - popCount(opponent);
+        int mobility = popCount(ownMoves) - popCount(getMoves<N>(opponent, own));
+        int corner = popCount(own & corners) - popCount(opponent & corners);
+        int adjacents = popCount(opponent & risky) - popCount(own & risky);
+
+        return weights.pieces * pieces + weights.mobility * mobility +
+               weights.corners * corner + weights.adjacents * adjacents;
+    }
+
+    int negamax(Bits own, Bits opponent, int height, int alpha, int beta, int &bestSquare)
+    {
+        nodes++;
+        bestSquare = -1;
+
+        Bits moves = getMoves<N>(own, opponent);
+        if (!moves)
+        {
+            if (!getMoves<N>(opponent, own))
+                return FINAL_DISC_VALUE * (popCount(own) - popCount(opponent));
+
+            int ignored;
+            return -negamax(opponent, own, height, -beta, -alpha, ignored);
+        }
+        if (height == 0)
+            return evaluate(own, opponent, moves);
+
+        // Primero las esquinas
+        const Bits corners = cornersMask<Bits>(N);
+        Bits ordered[2] = {moves & corners, moves & ~corners};
+        int best = -SEARCH_INFINITY;
+
+        for (int group = 0; group < 2; group++)
+            for (Bits pending = ordered[group]; pending; pending &= pending - 1)
+            {
+                int square = lowestSquare(pending);
+                Bits flips = getFlips<N>(square, own, opponent);
+                Bits child = own | flips | ((Bits)1 << square);
+
+                int ignored;
+                int value = -negamax(opponent & ~flips, child, height - 1, -beta, -alpha, ignored);
+                if (value > best)
+                {
+                    best = value;
+                    bestSquare = square;
+                }
+                if (best > alpha)
+                    alpha = best;
+                if (alpha >= beta)
+                    return best;
+            }
+
+        return best;
+    }
+};
+
+template <int N>
+VariantResult searchVariantBoard(VariantBoard<N> const&board, int maxDepth,
+                                 EvalWeights const&weights)
+{
+    typedef typename VariantBits<N>::Type Bits;
+
+    VariantSearch<N> search;
+    search.weights = weights;
+    search.nodes = 0;
+
+    Bits own = (board.currentPlayer == PLAYER_BLACK) ? board.black : board.white;
+    Bits opponent = (board.currentPlayer == PLAYER_BLACK) ? board.white : board.black;
+
+    // Sin limite alcanza con la cantidad de casillas vacias
+    int height = (maxDepth > 0) ? maxDepth : N * N;
+
+    int square;
+    VariantResult result;
+    result.value = search.negamax(own, opponent, height, -SEARCH_INFINITY, SEARCH_INFINITY, square);
+    result.nodes = search.nodes;
+    result.bestMove = GAME_INVALID_SQUARE;
+    if (square >= 0)
+        result.bestMove = {square % N, square / N};
+    return result;
+}
+
+// Una instancia completa por tamaño
+#define INSTANTIATE_VARIANT(N)                                                           \
+    template void startVariantBoard<N>(VariantBoard<N> &);                                \
+    template VariantBits<N>::Type getVariantMovesMask<N>(VariantBoard<N> const&);         \
+    template bool playVariantBoardMove<N>(VariantBoard<N> &, int);                        \
+    template VariantResult searchVariantBoard<N>(VariantBoard<N> const&, int, EvalWeights const&);
+
+INSTANTIATE_VARIANT(4)
+INSTANTIATE_VARIANT(6)
+INSTANTIATE_VARIANT(8)
+INSTANTIATE_VARIANT(10)
+
+// Conversion entre el tablero de tamaño variable y los bitboards de cada tamaño
+
+template <int N>
+static VariantBoard<N> toVariantBoard(VariantState const&state)
+{
+    typedef typename VariantBits<N>::Type Bits;
+
+    VariantBoard<N> board = {0, 0, state.currentPlayer, state.gameOver};
+    for (int y = 0; y < N; y++)
+        for (int x = 0; x < N; x++)
+        {
+            if (state.board[y][x] == PIECE_BLACK)
+                board.black |= squareMask<Bits>(N, x, y);
+            else if (state.board[y][x] == PIECE_WHITE)
+                board.white |= squareMask<Bits>(N, x, y);
+        }
+    return board;
+}
+
+template <int N>
+static void fromVariantBoard(VariantBoard<N> const&board, VariantState &state)
+{
+    typedef typename VariantBits<N>::Type Bits;
+
+    state.size = N;
+    state.currentPlayer = board.currentPlayer;
+    state.gameOver = board.gameOver;
+    memset(state.board, PIECE_EMPTY, sizeof(state.board));
+
+    for (int y = 0; y < N; y++)
+        for (int x = 0; x < N; x++)
+        {
+            if (board.black & squareMask<Bits>(N, x, y))
+                state.board[y][x] = PIECE_BLACK;
+            else if (board.white & squareMask<Bits>(N, x, y))
+                state.board[y][x] = PIECE_WHITE;
+        }
+}
+
+template <int N>
+static void startAs(VariantState &state)
+{
+    VariantBoard<N> board;
+    startVariantBoard(board);
+    fromVariantBoard(board, state);
+}
+
+template <int N>
+static void getMovesAs(VariantState const&state, Moves &validMoves)
+{
+    VariantBoard<N> board = toVariantBoard<N>(state);
+    if (board.gameOver)
+        return;
+
+    for (typename VariantBits<N>::Type moves = getVariantMovesMask(board); moves; moves &= moves - 1)
+    {
+        int square = lowestSquare(moves);
+        validMoves.push_back({square % N, square / N});
+    }
+}
+
+template <int N>
+static bool playAs(VariantState &state, Square move)
+{
+    VariantBoard<N> board = toVariantBoard<N>(state);
+    if (!playVariantBoardMove(board, move.y * N + move.x))
+        return false;
+
+    fromVariantBoard(board, state);
+    return true;
+}
+
+template <int N>
+static VariantResult searchAs(VariantState const&state, int maxDepth, EvalWeights const&weights)
+{
+    return searchVariantBoard(toVariantBoard<N>(state), maxDepth, weights);
+}
+
+bool isVariantSize(int size)
+{
+    return (size == 4) || (size == 6) || (size == 8) || (size == 10);
+}
+
+bool startVariant(VariantState &state, int size)
+{
+    switch (size)
+    {
+    case 4: startAs<4>(state); return true;
+    case 6: startAs<6>(state); return true;
+    case 8: startAs<8>(state); return true;
+    case 10: startAs<10>(state); return true;
+    default: return false;
+    }
+}
+
+void getVariantMoves(VariantState const&state, Moves &validMoves)
+{
+    validMoves.clear();
+
+    switch (state.size)
+    {
+    case 4: getMovesAs<4>(state, validMoves); break;
+    case 6: getMovesAs<6>(state, validMoves); break;
+    case 8: getMovesAs<8>(state, validMoves); break;
+    case 10: getMovesAs<10>(state, validMoves); break;
+    }
+}
+
+bool playVariantMove(VariantState &state, Square move)
+{
+    if (move.x < 0 || move.x >= state.size || move.y < 0 || move.y >= state.size)
+        return false;
+
+    switch (state.size)
+    {
+    case 4: return playAs<4>(state, move);
+    case 6: return playAs<6>(state, move);
+    case 8: return playAs<8>(state, move);
+    case 10: return playAs<10>(state, move);
+    default: return false;
+    }
+}
+
+int getVariantScore(VariantState const&state, Player player)
+{
+    Piece piece = (player == PLAYER_BLACK) ? PIECE_BLACK : PIECE_WHITE;
+    int score = 0;
+
+    for (int y = 0; y < state.size; y++)
+        for (int x = 0; x < state.size; x++)
+            if (state.board[y][x] == piece)
+                score++;
+    return score;
+}
+
+VariantResult searchVariant(VariantState const&state, int maxDepth, EvalWeights const&weights)
+{
+    switch (state.size)
+    {
+    case 4: return searchAs<4>(state, maxDepth, weights);
+    case 6: return searchAs<6>(state, maxDepth, weights);
+    case 8: return searchAs<8>(state, maxDepth, weights);
+    case 10: return searchAs<10>(state, maxDepth, weights);
+    }
+
+    VariantResult result = {GAME_INVALID_SQUARE, 0, 0};
+    return result;
+}
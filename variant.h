@@ -0,0 +1,166 @@
+/**
+ * @brief Board-size generic Reversi engine for the 4x4, 6x6, 8x8 and 10x10 variants
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef VARIANT_H
+#define VARIANT_H
+
+#include <cstdint>
+
+#include "config.h"
+#include "model.h"
+
+#define VARIANT_MAX_SIZE 10
+
+// Tipo de bitboard de cada tamaño: 64 bits alcanzan hasta 8x8, 10x10 usa 128.
+// Bit (y * N + x) corresponde a la casilla {x, y}, igual que en bitboard.h
+template <int N>
+struct VariantBits;
+
+template <>
+struct VariantBits<4>
+{
+    typedef uint64_t Type;
+};
+
+template <>
+struct VariantBits<6>
+{
+    typedef uint64_t Type;
+};
+
+template <>
+struct VariantBits<8>
+{
+    typedef uint64_t Type;
+};
+
+template <>
+struct VariantBits<10>
+{
+    typedef unsigned __int128 Type;
+};
+
+template <int N>
+struct VariantBoard
+{
+    typedef typename VariantBits<N>::Type Bits;
+
+    Bits black;
+    Bits white;
+    Player currentPlayer;
+    bool gameOver;
+};
+
+struct VariantResult
+{
+    Square bestMove;            // GAME_INVALID_SQUARE si no hay jugadas
+    int value;                  // desde el punto de vista del que mueve
+    int nodes;
+};
+
+// Tablero de cualquier tamaño para elegir la variante en tiempo de ejecucion
+struct VariantState
+{
+    int size;
+    Player currentPlayer;
+    bool gameOver;
+    Piece board[VARIANT_MAX_SIZE][VARIANT_MAX_SIZE];
+};
+
+/**
+ * @brief Sets up the starting position of a variant.
+ *
+ * @param board The board.
+ */
+template <int N>
+void startVariantBoard(VariantBoard<N> &board);
+
+/**
+ * @brief Returns all valid moves of the player to move at once.
+ *
+ * @param board The board.
+ * @return One bit per valid move.
+ */
+template <int N>
+typename VariantBits<N>::Type getVariantMovesMask(VariantBoard<N> const&board);
+
+/**
+ * @brief Plays a move, with the same pass rules as playMove.
+ *
+ * @param board The board.
+ * @param square The move (y * N + x).
+ * @return The move was valid; otherwise nothing changes.
+ */
+template <int N>
+bool playVariantBoardMove(VariantBoard<N> &board, int square);
+
+/**
+ * @brief Searches a variant position with alpha-beta to a fixed depth.
+ *
+ * @param board The board.
+ * @param maxDepth The depth in plies, 0 searches until the end.
+ * @param weights The evaluation weights (pieces, mobility, corners, adjacents).
+ * @return The best move, its value and the nodes searched.
+ */
+template <int N>
+VariantResult searchVariantBoard(VariantBoard<N> const&board, int maxDepth,
+                                 EvalWeights const&weights);
+
+/**
+ * @brief Checks whether there is an engine for a board size.
+ *
+ * @param size The board size.
+ * @return The size is 4, 6, 8 or 10.
+ */
+bool isVariantSize(int size);
+
+/**
+ * @brief Sets up the starting position of a variant.
+ *
+ * @param state The state.
+ * @param size The board size.
+ * @return The size is supported.
+ */
+bool startVariant(VariantState &state, int size);
+
+/**
+ * @brief Returns a list of valid moves for the current player.
+ *
+ * @param state The state.
+ * @param validMoves A list that receives the valid moves.
+ */
+void getVariantMoves(VariantState const&state, Moves &validMoves);
+
+/**
+ * @brief Plays a move.
+ *
+ * @param state The state.
+ * @param move The move.
+ * @return Move accepted.
+ */
+bool playVariantMove(VariantState &state, Square move);
+
+/**
+ * @brief Returns the score of a player.
+ *
+ * @param state The state.
+ * @param player The player.
+ * @return The amount of discs.
+ */
+int getVariantScore(VariantState const&state, Player player);
+
+/**
+ * @brief Searches a position with the engine of its board size.
+ *
+ * @param state The state.
+ * @param maxDepth The depth in plies, 0 searches until the end.
+ * @param weights The evaluation weights.
+ * @return The best move, its value and the nodes searched.
+ */
+VariantResult searchVariant(VariantState const&state, int maxDepth, EvalWeights const&weights);
+
+#endif
@@ -5,12 +5,15 @@
  * @copyright Copyright (c) 2023-2024
  */
 
+#include <algorithm>
 #include <string>
 
 #include "raylib.h"
 #include <cmath>
 
+#include "ai.h"
 #include "controller.h"
+#include "liveanalysis.h"
 #include "model.h"
 
 #define GAME_NAME "EDAversi"
@@ -38,6 +41,7 @@
 
 #define TITLE_FONT_SIZE 72
 #define SUBTITLE_FONT_SIZE 36
+#define ANALYSIS_FONT_SIZE 20
 
 #define INFO_CENTERED_X (OUTERBORDER_SIZE + (WINDOW_WIDTH - OUTERBORDER_SIZE) / 2)
 
@@ -60,19 +64,74 @@
 
 #define LIGHTGREEN CLITERAL(Color){ 144, 238, 144, 255 }
 
+// Esperando al humano sin que nada cambie, la ventana baja a VIEW_IDLE_FPS
+#define VIEW_ACTIVE_FPS 60
+#define VIEW_IDLE_FPS 10
+#define VIEW_IDLE_FRAMES 60
+
+// Lo que se ve en el cuadro: si no cambia, se muestra el cuadro guardado
+struct FrameKey
+{
+    int version;
+    int blackSeconds;
+    int whiteSeconds;
+    int shownMoves;             // jugadas marcadas, -1 = turno de la IA
+    int analysisSequence;       // resultados del analisis mostrados, -1 = ninguno
+};
+
+// Fondo, borde, casillas y titulo: se dibujan una sola vez
+static RenderTexture2D g_boardTexture;
+
+// El tablero con fichas, marcas y textos del ultimo cambio
+static RenderTexture2D g_frameTexture;
+static FrameKey g_frameKey;
+static bool g_frameValid = false;
+
+static int g_idleFrames = 0;
+static int g_targetFPS = VIEW_ACTIVE_FPS;
+
+static void drawBoard();
+
 void initView()
 {
     InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, GAME_NAME);
 
-    SetTargetFPS(60);
+    SetTargetFPS(VIEW_ACTIVE_FPS);
+
+    g_boardTexture = LoadRenderTexture(WINDOW_WIDTH, WINDOW_HEIGHT);
+    g_frameTexture = LoadRenderTexture(WINDOW_WIDTH, WINDOW_HEIGHT);
+    g_frameValid = false;
+
+    BeginTextureMode(g_boardTexture);
+    drawBoard();
+    EndTextureMode();
 }
 
 void freeView()
 {
+    UnloadRenderTexture(g_frameTexture);
+    UnloadRenderTexture(g_boardTexture);
     CloseWindow();
     
 }
 
+/**
+ * @brief Draws a render texture over the whole window.
+ *
+ * @param target The texture.
+ */
+static void drawRenderTexture(RenderTexture2D const&target)
+{
+    // Las texturas de render quedan dadas vuelta en y
+    DrawTextureRec(target.texture,
+                   {0,
+                    0,
+                    (float)target.texture.width,
+                    -(float)target.texture.height},
+                   {0, 0},
+                   WHITE);
+}
+
 /**
  * @brief Draws centered text.
  *
@@ -170,11 +229,11 @@ static bool isMousePointerOverButton(Vector2 position)
             (mousePosition.y < (position.y + INFO_BUTTON_HEIGHT / 2)));
 }
 
-void drawView(GameModel &model, Moves validMoves)
+/**
+ * @brief Draws the parts of the view that never change.
+ */
+static void drawBoard()
 {
-    BeginDrawing();
-    
-
     ClearBackground(BEIGE);
 
     DrawRectangle(
@@ -188,11 +247,9 @@ void drawView(GameModel &model, Moves validMoves)
     {
         for (int x = 0; x < BOARD_SIZE; x++)
         {
-            Square square = {x, y};
-
             Vector2 position = {
-                BOARD_X + (float)square.x * SQUARE_SIZE,
-                BOARD_Y + (float)square.y * SQUARE_SIZE};
+                BOARD_X + (float)x * SQUARE_SIZE,
+                BOARD_Y + (float)y * SQUARE_SIZE};
 
             DrawRectangleRounded(
                 {position.x + SQUARE_CONTENT_OFFSET,
@@ -202,18 +259,76 @@ void drawView(GameModel &model, Moves validMoves)
                 0.2F,
                 6,
                DARKGREEN);
-                
+        }
+    }
+
+    drawCenteredText({INFO_CENTERED_X,
+                      INFO_TITLE_Y},
+                     TITLE_FONT_SIZE,
+                     GAME_NAME);
+}
+
+/**
+ * @brief Draws the value of each analyzed move over its square, the best
+ *        ones darker.
+ *
+ * @param analysis The analysis of the position shown.
+ */
+static void drawAnalysis(LiveAnalysisSnapshot const&analysis)
+{
+    int best = -SEARCH_INFINITY;
+    for (int i = 0; i < analysis.count; i++)
+        if (analysis.moves[i].depth >= 0)
+            best = std::max(best, analysis.moves[i].value);
+
+    for (int i = 0; i < analysis.count; i++)
+    {
+        LiveMoveScore const&score = analysis.moves[i];
+        if (score.depth < 0)
+            continue;
+
+        std::string s = (score.value > 0) ? "+" + std::to_string(score.value) : std::to_string(score.value);
+        int width = MeasureText(s.c_str(), ANALYSIS_FONT_SIZE);
+        DrawText(s.c_str(),
+                 BOARD_X + score.move.x * SQUARE_SIZE + (SQUARE_SIZE - width) / 2,
+                 BOARD_Y + score.move.y * SQUARE_SIZE + (SQUARE_SIZE - ANALYSIS_FONT_SIZE) / 2,
+                 ANALYSIS_FONT_SIZE,
+                 (score.value == best) ? BLACK : DARKGRAY);
+    }
+}
+
+/**
+ * @brief Draws the pieces, highlights, scores, timers and buttons over the
+ *        board.
+ *
+ * @param model The game model.
+ * @param validMoves The moves to highlight.
+ * @param analysis The values of the highlighted moves, or nullptr.
+ * @param key What the frame shows.
+ */
+static void drawFrame(GameModel &model, Moves const&validMoves,
+                      LiveAnalysisSnapshot const *analysis, FrameKey const&key)
+{
+    drawRenderTexture(g_boardTexture);
+
+    for (int y = 0; y < BOARD_SIZE; y++)
+    {
+        for (int x = 0; x < BOARD_SIZE; x++)
+        {
+            Square square = {x, y};
             Piece piece = getBoardPiece(model, square);
 
             if (piece != PIECE_EMPTY)
-                DrawCircle((int)position.x + PIECE_CENTER,
-                           (int)position.y + PIECE_CENTER,
+                DrawCircle(BOARD_X + x * SQUARE_SIZE + PIECE_CENTER,
+                           BOARD_Y + y * SQUARE_SIZE + PIECE_CENTER,
                            PIECE_RADIUS,
                            (piece == PIECE_WHITE) ? WHITE : BLACK);
         }
     }
-    if(model.tree.currentPlayer==model.humanPlayer){
-        for(auto move:validMoves){
+    if (key.shownMoves >= 0)
+    {
+        for (auto move : validMoves)
+        {
             Vector2 position = {
                 BOARD_X + (float)move.x * SQUARE_SIZE,
                 BOARD_Y + (float)move.y * SQUARE_SIZE};
@@ -226,7 +341,8 @@ void drawView(GameModel &model, Moves validMoves)
                 6,
                 LIGHTGREEN);
         }
-            
+        if (analysis != nullptr)
+            drawAnalysis(*analysis);
     }
     drawScore("Black score: ",
               {INFO_CENTERED_X,
@@ -235,12 +351,7 @@ void drawView(GameModel &model, Moves validMoves)
                            PLAYER_BLACK));
     drawTimer({INFO_CENTERED_X,
                INFO_WHITE_TIME_Y},
-              getTimer(model,
-                           PLAYER_BLACK));
-    drawCenteredText({INFO_CENTERED_X,
-                      INFO_TITLE_Y},
-                     TITLE_FONT_SIZE,
-                     GAME_NAME);
+              key.blackSeconds);
     drawScore("White score: ",
               {INFO_CENTERED_X,
                INFO_BLACK_SCORE_Y},
@@ -248,8 +359,7 @@ void drawView(GameModel &model, Moves validMoves)
                            PLAYER_WHITE));
     drawTimer({INFO_CENTERED_X,
                INFO_BLACK_TIME_Y},
-              getTimer(model,
-                           PLAYER_WHITE));
+              key.whiteSeconds);
 
     if (model.tree.gameOver)
     {
@@ -263,7 +373,53 @@ void drawView(GameModel &model, Moves validMoves)
                    "Play white",
                    WHITE);
     }
-    
+}
+
+void drawView(GameModel &model, Moves const &validMoves, LiveAnalysisSnapshot const *analysis)
+{
+    bool humanTurn = (model.tree.currentPlayer == model.humanPlayer);
+    if (analysis != nullptr && (!humanTurn || analysis->version != model.version))
+        analysis = nullptr;
+
+    FrameKey key = {model.version,
+                    (int)getTimer(model, PLAYER_BLACK),
+                    (int)getTimer(model, PLAYER_WHITE),
+                    humanTurn ? (int)validMoves.size() : -1,
+                    analysis ? analysis->sequence : -1};
+
+    bool modelChanged = !g_frameValid || (key.version != g_frameKey.version) ||
+                        (key.shownMoves != g_frameKey.shownMoves);
+    if (modelChanged ||
+        (key.blackSeconds != g_frameKey.blackSeconds) ||
+        (key.whiteSeconds != g_frameKey.whiteSeconds) ||
+        (key.analysisSequence != g_frameKey.analysisSequence))
+    {
+        BeginTextureMode(g_frameTexture);
+        drawFrame(model, validMoves, analysis, key);
+        EndTextureMode();
+
+        g_frameKey = key;
+        g_frameValid = true;
+    }
+
+    // Mientras piensa la IA no se baja: drawView tambien se llama desde la
+    // busqueda y EndDrawing la frenaria
+    Vector2 mouseDelta = GetMouseDelta();
+    bool waiting = model.tree.gameOver || humanTurn;
+    bool active = modelChanged || !waiting ||
+                  (mouseDelta.x != 0) || (mouseDelta.y != 0) ||
+                  IsMouseButtonDown(0) || IsWindowResized();
+    g_idleFrames = active ? 0 : g_idleFrames + 1;
+
+    int targetFPS = (g_idleFrames >= VIEW_IDLE_FRAMES) ? VIEW_IDLE_FPS : VIEW_ACTIVE_FPS;
+    if (targetFPS != g_targetFPS)
+    {
+        SetTargetFPS(targetFPS);
+        g_targetFPS = targetFPS;
+    }
+
+    BeginDrawing();
+    drawRenderTexture(g_frameTexture);
     EndDrawing();
 }
 
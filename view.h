@@ -8,6 +8,7 @@
 #ifndef VIEW_H
 #define VIEW_H
 
+#include "liveanalysis.h"
 #include "model.h"
 
 /**
@@ -21,17 +22,16 @@ void initView();
 void freeView();
 
 /**
- * @brief Draws the posible moves in the players turn.
+ * @brief Draws the game view. The frame is rendered again only when the
+ *        model version or the timers change; otherwise the last one is
+ *        shown, at a lower frame rate while waiting for the human player.
  *
  * @param model The game model.
+ * @param validMoves The moves to highlight on the human player's turn.
+ * @param analysis Values to show over the highlighted moves, used if it is
+ *                 for the current model version. nullptr shows none.
  */
-void drawPosibleMoves(GameModel &model, Moves validMoves);
-/**
- * @brief Draws the game view.
- *
- * @param model The game model.
- */
-void drawView(GameModel &model, Moves validMoves);
+void drawView(GameModel &model, Moves const &validMoves, LiveAnalysisSnapshot const *analysis);
 
 /**
  * @brief Returns the square over the mouse pointer.
@@ -0,0 +1,213 @@
+/**
+ * @brief WTHOR and plain transcript game records
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#include <cctype>
+#include <cstring>
+#include <ctime>
+
+#include "bitboard.h"
+#include "gamedb.h"
+#include "wthor.h"
+
+// Simetrias que dejan igual la posicion inicial: identidad, rotacion de 180
+// grados y las dos trasposiciones
+static const int START_SYMMETRIES[4] = {0, 3, 4, 7};
+
+static int readLE16(const uint8_t *data)
+{
+    return data[0] | (data[1] << 8);
+}
+
+static int readLE32(const uint8_t *data)
+{
+    return data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
+}
+
+static void writeLE16(uint8_t *data, int value)
+{
+    data[0] = value & 0xff;
+    data[1] = (value >> 8) & 0xff;
+}
+
+static void writeLE32(uint8_t *data, int value)
+{
+    writeLE16(data, value & 0xffff);
+    writeLE16(data + 2, (value >> 16) & 0xffff);
+}
+
+bool readWthorHeader(const uint8_t *data, WthorHeader &header)
+{
+    header.creationYear = data[0] * 100 + data[1];
+    header.creationMonth = data[2];
+    header.creationDay = data[3];
+    header.gameCount = readLE32(data + 4);
+    header.gamesYear = readLE16(data + 10);
+    header.boardSize = data[12];
+
+    return header.boardSize == 0 || header.boardSize == 8;
+}
+
+void writeWthorHeader(uint8_t *data, int gameCount)
+{
+    time_t now = time(nullptr);
+    struct tm *date = localtime(&now);
+    int year = date->tm_year + 1900;
+
+    memset(data, 0, WTHOR_HEADER_SIZE);
+    data[0] = year / 100;
+    data[1] = year % 100;
+    data[2] = date->tm_mon + 1;
+    data[3] = date->tm_mday;
+    writeLE32(data + 4, gameCount);
+    writeLE16(data + 10, year);
+    data[12] = 8;
+}
+
+// Las jugadas WTHOR son 10 * fila + columna, ambas desde 1
+int readWthorGame(const uint8_t *record, uint8_t *moves)
+{
+    const uint8_t *wthorMoves = record + 8;
+    int count = 0;
+
+    while (count < WTHOR_MAX_MOVES && wthorMoves[count] != 0)
+    {
+        int row = wthorMoves[count] / 10 - 1;
+        int column = wthorMoves[count] % 10 - 1;
+        if (row < 0 || row >= 8 || column < 0 || column >= 8)
+            return -1;
+
+        moves[count] = packSquare(Square{column, row});
+        count++;
+    }
+
+    return count;
+}
+
+// Juega la partida desde la posicion inicial, deteniendose en la primera
+// jugada invalida
+static bool replayGame(const uint8_t *moves, int moveCount, Bitboard &board)
+{
+    tree_logic start;
+    startState(start);
+    board = getBitboard(start);
+    Player player = start.currentPlayer;
+
+    for (int i = 0; i < moveCount; i++)
+    {
+        if (!playBitboardMove(board, player, moves[i]))
+            return false;
+    }
+
+    return true;
+}
+
+void writeWthorGame(uint8_t *record, const uint8_t *moves, int moveCount)
+{
+    memset(record, 0, WTHOR_RECORD_SIZE);
+
+    // Puntaje real: fichas negras, con las casillas vacias para el ganador.
+    // El puntaje teorico queda en 0, como indica la profundidad 0 de la
+    // cabecera: no se calcula
+    Bitboard board;
+    replayGame(moves, moveCount, board);
+    int blackDiscs = __builtin_popcountll(board.black);
+    int whiteDiscs = __builtin_popcountll(board.white);
+    int empty = 64 - blackDiscs - whiteDiscs;
+    if (blackDiscs > whiteDiscs)
+        blackDiscs += empty;
+    else if (blackDiscs == whiteDiscs)
+        blackDiscs += empty / 2;
+    record[6] = blackDiscs;
+
+    for (int i = 0; i < moveCount && i < WTHOR_MAX_MOVES; i++)
+    {
+        Square square = unpackSquare(moves[i]);
+        record[8 + i] = 10 * (square.y + 1) + (square.x + 1);
+    }
+}
+
+int parseTranscript(std::string const&line, uint8_t *moves)
+{
+    int count = 0;
+    size_t i = 0;
+
+    while (i < line.size())
+    {
+        if (isspace((unsigned char)line[i]))
+        {
+            i++;
+            continue;
+        }
+        if (i + 1 >= line.size() || count >= WTHOR_MAX_MOVES)
+            return -1;
+
+        int column = toupper((unsigned char)line[i]) - 'A';
+        int row = line[i + 1] - '1';
+        if (row < 0 || row >= 8 || column < 0 || column >= 8)
+            return -1;
+
+        moves[count++] = packSquare(Square{column, row});
+        i += 2;
+    }
+
+    return count;
+}
+
+std::string formatTranscript(const uint8_t *moves, int moveCount)
+{
+    std::string s;
+    s.reserve(moveCount * 2);
+
+    for (int i = 0; i < moveCount; i++)
+    {
+        Square square = unpackSquare(moves[i]);
+        s.push_back(char('A' + square.x));
+        s.push_back(char('1' + square.y));
+    }
+
+    return s;
+}
+
+bool validateGame(const uint8_t *moves, int moveCount, int &discDiff)
+{
+    Bitboard board;
+    if (!replayGame(moves, moveCount, board))
+        return false;
+
+    discDiff = __builtin_popcountll(board.black) - __builtin_popcountll(board.white);
+    return true;
+}
+
+uint64_t canonicalGameHash(const uint8_t *moves, int moveCount)
+{
+    uint8_t best[WTHOR_MAX_MOVES];
+    uint8_t candidate[WTHOR_MAX_MOVES];
+    int count = (moveCount < WTHOR_MAX_MOVES) ? moveCount : WTHOR_MAX_MOVES;
+
+    memcpy(best, moves, count);
+
+    for (int s = 1; s < 4; s++)
+    {
+        for (int i = 0; i < count; i++)
+            candidate[i] = packSquare(transformSquare(unpackSquare(moves[i]), START_SYMMETRIES[s]));
+
+        if (memcmp(candidate, best, count) < 0)
+            memcpy(best, candidate, count);
+    }
+
+    // FNV-1a sobre la secuencia canonica
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < count; i++)
+    {
+        hash ^= best[i];
+        hash *= 0x100000001b3ULL;
+    }
+    hash ^= count;
+    hash *= 0x100000001b3ULL;
+
+    return hash;
+}
@@ -0,0 +1,104 @@
+/**
+ * @brief WTHOR and plain transcript game records
+ * @author Marc S. Ressl
+ *
+ * @copyright Copyright (c) 2023-2024
+ */
+
+#ifndef WTHOR_H
+#define WTHOR_H
+
+#include <cstdint>
+#include <string>
+
+#define WTHOR_HEADER_SIZE 16
+#define WTHOR_RECORD_SIZE 68
+#define WTHOR_MAX_MOVES 60
+
+// Cabecera de un archivo .wtb (todos los enteros en little endian)
+struct WthorHeader
+{
+    int creationYear;
+    int creationMonth;
+    int creationDay;
+    int gameCount;
+    int gamesYear;
+    int boardSize;              // 0 u 8 = 8x8
+};
+
+/**
+ * @brief Reads the 16-byte header of a WTHOR file.
+ *
+ * @param data The header bytes.
+ * @param header Receives the header.
+ * @return It is an 8x8 game file.
+ */
+bool readWthorHeader(const uint8_t *data, WthorHeader &header);
+
+/**
+ * @brief Writes the 16-byte header of a WTHOR game file.
+ *
+ * @param data Receives the header bytes.
+ * @param gameCount The amount of games.
+ */
+void writeWthorHeader(uint8_t *data, int gameCount);
+
+/**
+ * @brief Reads the moves of a 68-byte WTHOR game record.
+ *
+ * @param record The record.
+ * @param moves Receives the packed moves (y * 8 + x).
+ * @return The amount of moves, -1 if a move is not a square.
+ */
+int readWthorGame(const uint8_t *record, uint8_t *moves);
+
+/**
+ * @brief Writes a 68-byte WTHOR game record with unknown players and
+ *        tournament, and no theoretical score. The real score is replayed
+ *        from the moves, with the empty squares for the winner.
+ *
+ * @param record Receives the record.
+ * @param moves The packed moves, valid from the starting position.
+ * @param moveCount The amount of moves.
+ */
+void writeWthorGame(uint8_t *record, const uint8_t *moves, int moveCount);
+
+/**
+ * @brief Reads a transcript like "F5D6C3...", ignoring spaces.
+ *
+ * @param line The transcript.
+ * @param moves Receives the packed moves.
+ * @return The amount of moves, -1 if it is not a transcript.
+ */
+int parseTranscript(std::string const&line, uint8_t *moves);
+
+/**
+ * @brief Writes a transcript like "F5D6C3...".
+ *
+ * @param moves The packed moves.
+ * @param moveCount The amount of moves.
+ * @return The transcript.
+ */
+std::string formatTranscript(const uint8_t *moves, int moveCount);
+
+/**
+ * @brief Replays a game from the starting position checking every move.
+ *
+ * @param moves The packed moves.
+ * @param moveCount The amount of moves.
+ * @param discDiff Receives black discs minus white discs at the end.
+ * @return All moves were valid.
+ */
+bool validateGame(const uint8_t *moves, int moveCount, int &discDiff);
+
+/**
+ * @brief Hashes a game so that it matches its symmetric copies: the smallest
+ *        move sequence among the 4 symmetries that keep the starting position.
+ *
+ * @param moves The packed moves.
+ * @param moveCount The amount of moves.
+ * @return The hash.
+ */
+uint64_t canonicalGameHash(const uint8_t *moves, int moveCount);
+
+#endif